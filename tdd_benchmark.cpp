@@ -0,0 +1,566 @@
+//======= Copyright (c) 2025, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     Test Driven Development - graph benchmarks
+//
+// $NoKeywords: $ivs_project_1 $tdd_benchmark.cpp
+// $Author:     Jakub Lůčný <xlucnyj00@stud.fit.vutbr.cz>
+// $Date:       $2025-03-10
+//============================================================================//
+/**
+ * @file tdd_benchmark.cpp
+ * @author Jakub Lůčný
+ *
+ * @brief Měření výkonu operací nad grafem.
+ *
+ * Použití: tdd_benchmark [název měření|all] [maximální počet hran]
+ *
+ * Měření parallel pracuje s jediným grafem o zadaném počtu hran, řádek s jedním vláknem je sekvenční barvení.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "tdd_code.h"
+
+// Number of global operator new and delete calls, used by the pool benchmark
+static size_t allocationCount = 0;
+static size_t freeCount = 0;
+
+void* operator new(size_t size){
+    allocationCount++;
+    if (void* memory = std::malloc(size ? size : 1)){
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept{
+    freeCount += memory != nullptr;
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept{
+    freeCount += memory != nullptr;
+    std::free(memory);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Milliseconds elapsed since given time point
+double elapsedMs(Clock::time_point start){
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Random graph with average degree of 16, node ids are spread over a wide range
+// so they don't form a dense sequence
+std::vector<Edge> randomEdges(size_t edgeCount, uint64_t seed = 42){
+    std::mt19937_64 rng(seed);
+    size_t nodeCount = edgeCount / 8 + 2;
+    std::uniform_int_distribution<size_t> pick(0, nodeCount - 1);
+
+    std::vector<Edge> edges;
+    edges.reserve(edgeCount);
+    for (size_t i = 0; i < edgeCount; i++){
+        edges.emplace_back(pick(rng) * 7919, pick(rng) * 7919);
+    }
+    return edges;
+}
+
+// Graph construction and point queries for 10^3 .. maxEdges edges
+void benchBuild(size_t maxEdges){
+    std::cout << std::setw(10) << "edges" << std::setw(14) << "build [ms]"
+              << std::setw(16) << "contains [ms]" << std::setw(14) << "degree [ms]" << '\n';
+
+    for (size_t edgeCount = 1000; edgeCount <= maxEdges; edgeCount *= 10){
+        std::vector<Edge> edges = randomEdges(edgeCount);
+        Graph graph;
+
+        auto start = Clock::now();
+        graph.addMultipleEdges(edges);
+        double buildMs = elapsedMs(start);
+
+        size_t found = 0;
+        start = Clock::now();
+        for (const Edge& edge : edges){
+            found += graph.containsEdge(Edge(edge.b, edge.a));
+        }
+        double containsMs = elapsedMs(start);
+
+        size_t degrees = 0;
+        start = Clock::now();
+        for (const Edge& edge : edges){
+            if (edge.a != edge.b){
+                degrees += graph.nodeDegree(edge.a);
+            }
+        }
+        double degreeMs = elapsedMs(start);
+
+        std::cout << std::setw(10) << edgeCount << std::fixed << std::setprecision(2)
+                  << std::setw(14) << buildMs << std::setw(16) << containsMs
+                  << std::setw(14) << degreeMs << "   (" << found + degrees << ")\n";
+    }
+}
+
+// Degree queries and coloring on Graph versus its CSR snapshot
+void benchCsr(size_t maxEdges){
+    std::cout << std::setw(10) << "edges" << std::setw(14) << "freeze [ms]"
+              << std::setw(22) << "graphDegree x10" << std::setw(22) << "nodeDegree all"
+              << std::setw(24) << "coloring" << "   [ms, graph / csr]\n";
+
+    for (size_t edgeCount = 1000; edgeCount <= maxEdges; edgeCount *= 10){
+        Graph graph;
+        graph.addMultipleEdges(randomEdges(edgeCount));
+
+        auto start = Clock::now();
+        CsrGraph snapshot = graph.freeze();
+        double freezeMs = elapsedMs(start);
+
+        std::vector<size_t> ids;
+        for (Node* node : graph.nodes()){
+            ids.push_back(node->id);
+        }
+
+        // graph degree is a full traversal of all nodes
+        size_t checksum = 0;
+        start = Clock::now();
+        for (int round = 0; round < 10; round++){
+            checksum += graph.graphDegree();
+        }
+        double graphScanMs = elapsedMs(start);
+
+        start = Clock::now();
+        for (int round = 0; round < 10; round++){
+            checksum -= snapshot.graphDegree();
+        }
+        double csrScanMs = elapsedMs(start);
+
+        // point queries by node id
+        start = Clock::now();
+        for (size_t id : ids){
+            checksum += graph.nodeDegree(id);
+        }
+        double graphDegreeMs = elapsedMs(start);
+
+        start = Clock::now();
+        for (size_t id : ids){
+            checksum -= snapshot.nodeDegree(id);
+        }
+        double csrDegreeMs = elapsedMs(start);
+
+        // Graph::coloring is too slow to be measured on large graphs
+        std::string graphColoring = "-";
+        if (edgeCount <= 10000){
+            start = Clock::now();
+            graph.coloring();
+            graphColoring = std::to_string(elapsedMs(start));
+            graphColoring.resize(graphColoring.find('.') + 3);
+        }
+
+        start = Clock::now();
+        snapshot.coloring();
+        double csrColoringMs = elapsedMs(start);
+
+        std::cout << std::setw(10) << edgeCount << std::fixed << std::setprecision(2)
+                  << std::setw(14) << freezeMs
+                  << std::setw(12) << graphScanMs << " / " << std::setw(7) << csrScanMs
+                  << std::setw(12) << graphDegreeMs << " / " << std::setw(7) << csrDegreeMs
+                  << std::setw(14) << graphColoring << " / " << std::setw(7) << csrColoringMs
+                  << "   (" << checksum << ")\n";
+    }
+}
+
+// Time and number of colors for every coloring order on CSR snapshots
+void benchColoring(size_t maxEdges){
+    const std::pair<ColoringOrder, const char*> orders[] = {
+        {ColoringOrder::Natural, "natural"},
+        {ColoringOrder::LargestFirst, "largest-first"},
+        {ColoringOrder::SmallestLast, "smallest-last"},
+        {ColoringOrder::DSatur, "dsatur"},
+    };
+
+    std::cout << std::setw(10) << "edges" << std::setw(16) << "order" << std::setw(12) << "time [ms]"
+              << std::setw(10) << "colors" << std::setw(14) << "degree + 1" << '\n';
+
+    for (size_t edgeCount = 1000; edgeCount <= maxEdges; edgeCount *= 10){
+        Graph graph;
+        graph.addMultipleEdges(randomEdges(edgeCount));
+        CsrGraph snapshot = graph.freeze();
+
+        for (const auto& order : orders){
+            auto start = Clock::now();
+            snapshot.coloring(order.first);
+            double coloringMs = elapsedMs(start);
+
+            size_t colors = 0;
+            for (size_t i = 0; i < snapshot.nodeCount(); i++){
+                colors = std::max(colors, snapshot.color(snapshot.nodeId(i)));
+            }
+
+            std::cout << std::setw(10) << edgeCount << std::setw(16) << order.second << std::fixed
+                      << std::setprecision(2) << std::setw(12) << coloringMs << std::setw(10) << colors
+                      << std::setw(14) << snapshot.graphDegree() + 1 << '\n';
+        }
+    }
+}
+
+// True when no edge of the snapshot connects two nodes of the same color
+bool validColoring(const Graph& graph, const CsrGraph& snapshot){
+    for (const Edge& edge : graph.edges()){
+        if (snapshot.color(edge.a) == snapshot.color(edge.b) || snapshot.color(edge.a) == 0){
+            return false;
+        }
+    }
+    return true;
+}
+
+// Speculative coloring with conflict repair, scaling over threads on a single graph with maxEdges edges
+void benchSpeculative(size_t maxEdges){
+    Graph graph;
+    graph.addMultipleEdges(randomEdges(maxEdges));
+    CsrGraph snapshot = graph.freeze();
+
+    size_t maxThreads = std::max(4u, std::thread::hardware_concurrency());
+    std::cout << "edges: " << graph.edgeCount() << ", hardware threads: "
+              << std::thread::hardware_concurrency() << '\n';
+    std::cout << std::setw(10) << "threads" << std::setw(12) << "time [ms]" << std::setw(10) << "speedup"
+              << std::setw(10) << "colors" << std::setw(8) << "valid" << '\n';
+
+    double sequentialMs = 0;
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2){
+        auto start = Clock::now();
+        snapshot.coloring(ColoringOrder::Natural, threads);
+        double coloringMs = elapsedMs(start);
+        if (threads == 1){
+            sequentialMs = coloringMs;
+        }
+
+        size_t colors = 0;
+        for (size_t i = 0; i < snapshot.nodeCount(); i++){
+            colors = std::max(colors, snapshot.color(snapshot.nodeId(i)));
+        }
+
+        std::cout << std::setw(10) << threads << std::fixed << std::setprecision(2) << std::setw(12)
+                  << coloringMs << std::setw(10) << sequentialMs / coloringMs << std::setw(10) << colors
+                  << std::setw(8) << (validColoring(graph, snapshot) ? "yes" : "NO") << '\n';
+    }
+}
+
+// Repeated build/clear cycles of a graph with maxEdges / 8 nodes
+void benchPool(size_t maxEdges){
+    size_t nodeCount = maxEdges / 8;
+    std::vector<Edge> edges = randomEdges(maxEdges);
+    Graph graph;
+
+    std::cout << "nodes: " << nodeCount << ", edges: " << maxEdges << '\n';
+    std::cout << std::setw(8) << "cycle" << std::setw(16) << "nodes [ms]" << std::setw(16) << "allocations"
+              << std::setw(16) << "edges [ms]" << std::setw(16) << "allocations" << std::setw(14) << "clear [ms]"
+              << std::setw(10) << "frees" << '\n';
+
+    for (int cycle = 0; cycle < 5; cycle++){
+        size_t allocations = allocationCount;
+        auto start = Clock::now();
+        for (size_t id = 0; id < nodeCount; id++){
+            graph.addNode(id * 7919);
+        }
+        double nodesMs = elapsedMs(start);
+        size_t nodeAllocations = allocationCount - allocations;
+        graph.clear();
+
+        allocations = allocationCount;
+        start = Clock::now();
+        graph.addMultipleEdges(edges);
+        double edgesMs = elapsedMs(start);
+        size_t edgeAllocations = allocationCount - allocations;
+
+        size_t frees = freeCount;
+        start = Clock::now();
+        graph.clear();
+        double clearMs = elapsedMs(start);
+        frees = freeCount - frees;
+
+        std::cout << std::setw(8) << cycle << std::fixed << std::setprecision(2) << std::setw(16) << nodesMs
+                  << std::setw(16) << nodeAllocations << std::setw(16) << edgesMs << std::setw(16)
+                  << edgeAllocations << std::setw(14) << clearMs << std::setw(10) << frees << '\n';
+    }
+}
+
+// addEdge loop versus bulk addMultipleEdges, every edge appears twice (in both directions)
+void benchBulk(size_t maxEdges){
+    size_t threads = std::max(2u, std::thread::hardware_concurrency());
+    std::cout << std::setw(10) << "edges" << std::setw(16) << "addEdge [ms]" << std::setw(14) << "bulk [ms]"
+              << std::setw(12) << "bulk x" << threads << " [ms]" << std::setw(10) << "same" << '\n';
+
+    for (size_t edgeCount = 100000; edgeCount <= maxEdges; edgeCount *= 10){
+        std::vector<Edge> edges = randomEdges(edgeCount / 2);
+        for (size_t i = 0, count = edges.size(); i < count; i++){
+            edges.emplace_back(edges[i].b, edges[i].a);
+        }
+
+        Graph sequential;
+        auto start = Clock::now();
+        for (const Edge& edge : edges){
+            sequential.addEdge(edge);
+        }
+        double sequentialMs = elapsedMs(start);
+        std::vector<Edge> expected = sequential.edges();
+        sequential.clear();
+
+        Graph bulk;
+        start = Clock::now();
+        bulk.addMultipleEdges(edges, 1);
+        double bulkMs = elapsedMs(start);
+        bool same = bulk.edges() == expected;
+        bulk.clear();
+
+        start = Clock::now();
+        bulk.addMultipleEdges(edges, threads);
+        double parallelMs = elapsedMs(start);
+        same = same && bulk.edges() == expected;
+
+        std::cout << std::setw(10) << edgeCount << std::fixed << std::setprecision(2) << std::setw(16)
+                  << sequentialMs << std::setw(14) << bulkMs << std::setw(18) << parallelMs << std::setw(10)
+                  << (same ? "yes" : "NO") << '\n';
+    }
+}
+
+// Rebuilding a graph from its edge list versus loading a saved snapshot, the file stays in page cache
+void benchFile(size_t maxEdges){
+    const char* path = "tdd_benchmark.csr";
+    std::cout << std::setw(10) << "edges" << std::setw(14) << "rebuild [ms]" << std::setw(12) << "save [ms]"
+              << std::setw(16) << "mmap+query [ms]" << std::setw(18) << "Graph::load [ms]" << '\n';
+
+    for (size_t edgeCount = 100000; edgeCount <= maxEdges; edgeCount *= 10){
+        std::vector<Edge> edges = randomEdges(edgeCount);
+
+        Graph graph;
+        auto start = Clock::now();
+        graph.addMultipleEdges(edges, 1);
+        CsrGraph rebuilt = graph.freeze();
+        double rebuildMs = elapsedMs(start);
+
+        start = Clock::now();
+        graph.save(path);
+        double saveMs = elapsedMs(start);
+
+        start = Clock::now();
+        CsrGraph mapped = CsrGraph::load(path);
+        size_t degree = mapped.nodeDegree(edges.front().a);
+        double mappedMs = elapsedMs(start);
+
+        Graph loaded;
+        start = Clock::now();
+        loaded.load(path);
+        double loadMs = elapsedMs(start);
+
+        bool same = degree == rebuilt.nodeDegree(edges.front().a) && loaded.edgeCount() == graph.edgeCount();
+        std::cout << std::setw(10) << edgeCount << std::fixed << std::setprecision(2) << std::setw(14) << rebuildMs
+                  << std::setw(12) << saveMs << std::setw(16) << mappedMs << std::setw(18) << loadMs
+                  << (same ? "" : "  MISMATCH") << '\n';
+    }
+    std::remove(path);
+}
+
+// Iterating all edges and neighbor lists through copies versus zero-copy ranges
+void benchRanges(size_t maxEdges){
+    const size_t passes = 1000;
+    std::cout << std::setw(10) << "edges" << std::setw(16) << "edges() [ms]" << std::setw(18) << "edgeRange() [ms]"
+              << std::setw(16) << "allocations" << std::setw(20) << "neighbors() [ms]" << '\n';
+
+    size_t edgeCount = std::min<size_t>(maxEdges, 1000000);
+    Graph graph;
+    graph.addMultipleEdges(randomEdges(edgeCount), 1);
+
+    size_t copySum = 0;
+    auto start = Clock::now();
+    size_t allocationsBefore = allocationCount;
+    for (size_t pass = 0; pass < passes; pass++){
+        for (const Edge& edge : graph.edges()){
+            copySum += edge.a ^ edge.b;
+        }
+    }
+    double copyMs = elapsedMs(start);
+    size_t copyAllocations = allocationCount - allocationsBefore;
+
+    size_t rangeSum = 0;
+    start = Clock::now();
+    allocationsBefore = allocationCount;
+    for (size_t pass = 0; pass < passes; pass++){
+        for (const Edge& edge : graph.edgeRange()){
+            rangeSum += edge.a ^ edge.b;
+        }
+    }
+    double rangeMs = elapsedMs(start);
+    size_t rangeAllocations = allocationCount - allocationsBefore;
+
+    // Sum of all neighbor ids, once per node
+    size_t neighborSum = 0;
+    start = Clock::now();
+    for (const Node* node : graph.nodeRange()){
+        for (size_t neighbor : graph.neighbors(node->id)){
+            neighborSum += neighbor;
+        }
+    }
+    double neighborsMs = elapsedMs(start);
+
+    std::cout << std::setw(10) << graph.edgeCount() << std::fixed << std::setprecision(2) << std::setw(16) << copyMs
+              << std::setw(18) << rangeMs << std::setw(8) << copyAllocations << " / " << std::setw(5)
+              << rangeAllocations << std::setw(20) << neighborsMs << (copySum == rangeSum && neighborSum ? "" : "  MISMATCH")
+              << '\n';
+}
+
+// Random mix of 70 % addEdge, 20 % removeEdge and 10 % removeNode over a growing id range, maxEdges operations
+// in ten batches, throughput of every batch should stay roughly the same as the graph grows
+void benchChurn(size_t maxEdges){
+    std::cout << std::setw(10) << "operations" << std::setw(10) << "nodes" << std::setw(10) << "edges"
+              << std::setw(14) << "batch [ms]" << std::setw(14) << "ops / ms" << '\n';
+
+    std::mt19937_64 rng(42);
+    Graph graph;
+    std::vector<Edge> added;
+    size_t batch = std::max<size_t>(maxEdges / 10, 1);
+
+    for (size_t done = 0; done < maxEdges; done += batch){
+        auto start = Clock::now();
+        for (size_t step = done; step < done + batch; step++){
+            size_t nodeSpace = 1000 + step / 16;
+            size_t action = rng() % 10;
+            if (action < 7){
+                Edge edge(rng() % nodeSpace, rng() % nodeSpace);
+                if (graph.addEdge(edge)){
+                    added.push_back(edge);
+                }
+            }
+            else if (action < 9 && !added.empty()){
+                // Edges removed together with their nodes are skipped lazily
+                size_t i = rng() % added.size();
+                if (graph.containsEdge(added[i])){
+                    graph.removeEdge(added[i]);
+                }
+                added[i] = added.back();
+                added.pop_back();
+            }
+            else{
+                size_t nodeId = rng() % nodeSpace;
+                if (graph.getNode(nodeId) != nullptr){
+                    graph.removeNode(nodeId);
+                }
+            }
+        }
+        double batchMs = elapsedMs(start);
+
+        std::cout << std::setw(10) << done + batch << std::setw(10) << graph.nodeCount() << std::setw(10)
+                  << graph.edgeCount() << std::fixed << std::setprecision(2) << std::setw(14) << batchMs
+                  << std::setw(14) << batch / batchMs << '\n';
+    }
+}
+
+// Latency of recoloring after a small batch of updates, full coloring versus updateColoring
+void benchIncremental(size_t maxEdges){
+    const size_t rounds = 20;
+    std::cout << std::setw(10) << "edges" << std::setw(10) << "updates" << std::setw(18) << "coloring() [ms]"
+              << std::setw(22) << "updateColoring() [ms]" << std::setw(10) << "valid" << '\n';
+
+    std::vector<Edge> edges = randomEdges(maxEdges);
+    size_t nodeSpace = maxEdges / 8 + 2;
+    for (size_t updates : {10, 100, 1000}){
+        Graph full, incremental;
+        full.addMultipleEdges(edges, 1);
+        incremental.addMultipleEdges(edges, 1);
+        full.coloring();
+        incremental.coloring();
+
+        std::mt19937_64 rng(updates);
+        double fullMs = 0, incrementalMs = 0;
+        for (size_t round = 0; round < rounds; round++){
+            // Same random changes on both graphs: half added edges, half removed ones
+            for (size_t i = 0; i < updates; i++){
+                Edge edge(rng() % nodeSpace * 7919, rng() % nodeSpace * 7919);
+                if (i % 2 == 0){
+                    full.addEdge(edge);
+                    incremental.addEdge(edge);
+                }
+                else{
+                    const Edge existing = full.edgeRange().begin()[rng() % full.edgeCount()];
+                    full.removeEdge(existing);
+                    incremental.removeEdge(existing);
+                }
+            }
+
+            auto start = Clock::now();
+            full.coloring();
+            fullMs += elapsedMs(start);
+
+            start = Clock::now();
+            incremental.updateColoring();
+            incrementalMs += elapsedMs(start);
+        }
+
+        bool valid = true;
+        size_t maxColor = incremental.graphDegree() + 1;
+        for (const Edge& edge : incremental.edgeRange()){
+            valid = valid && incremental.getNode(edge.a)->color != incremental.getNode(edge.b)->color;
+        }
+        for (const Node* node : incremental.nodeRange()){
+            valid = valid && node->color >= 1 && node->color <= maxColor;
+        }
+
+        std::cout << std::setw(10) << incremental.edgeCount() << std::setw(10) << updates << std::fixed
+                  << std::setprecision(3) << std::setw(18) << fullMs / rounds << std::setw(22)
+                  << incrementalMs / rounds << std::setw(10) << (valid ? "yes" : "NO") << '\n';
+    }
+}
+
+struct Benchmark{
+    const char* name;
+    void (*run)(size_t maxEdges);
+};
+
+const Benchmark benchmarks[] = {
+    {"build", benchBuild},
+    {"csr", benchCsr},
+    {"coloring", benchColoring},
+    {"speculative", benchSpeculative},
+    {"pool", benchPool},
+    {"bulk", benchBulk},
+    {"file", benchFile},
+    {"ranges", benchRanges},
+    {"churn", benchChurn},
+    {"incremental", benchIncremental},
+};
+
+} // namespace
+
+int main(int argc, char* argv[]){
+    const char* selected = argc > 1 ? argv[1] : "all";
+    size_t maxEdges = argc > 2 ? std::stoull(argv[2]) : 1000000;
+
+    bool matched = false;
+    for (const Benchmark& benchmark : benchmarks){
+        if (std::strcmp(selected, "all") == 0 || std::strcmp(selected, benchmark.name) == 0){
+            std::cout << "== " << benchmark.name << " ==\n";
+            benchmark.run(maxEdges);
+            matched = true;
+        }
+    }
+
+    if (!matched){
+        std::cerr << "Unknown benchmark: " << selected << '\n';
+        return 1;
+    }
+    return 0;
+}
+
+/*** Konec souboru tdd_benchmark.cpp ***/
@@ -16,6 +16,383 @@
 
 #include "tdd_code.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <numeric>
+#include <set>
+#include <thread>
+#include <tuple>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TDD_CODE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace {
+
+/// Začátek souboru se snímkem grafu, "IVSCSR01" v little-endian
+constexpr size_t CSR_FILE_MAGIC = 0x3130525343535649ULL;
+
+// Soubor se snímkem ukládá 64bitová slova přímo z paměti
+static_assert(sizeof(size_t) == 8, "CsrGraph file format requires 64-bit size_t");
+
+/**
+ * @brief Rozdělí interval [0, count) mezi vlákna.
+ *
+ * Funkce je volána jako function(begin, end, thread), první část zpracuje volající vlákno.
+ */
+template<typename Function>
+void parallelFor(size_t threads, size_t count, Function function){
+    size_t chunk = (count + threads - 1) / threads;
+    if (threads <= 1 || chunk == 0){
+        function(0, count, 0);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    for (size_t thread = 1; thread < threads && thread * chunk < count; thread++){
+        workers.emplace_back(function, thread * chunk, std::min(count, (thread + 1) * chunk), thread);
+    }
+    function(0, std::min(count, chunk), 0);
+
+    for (auto& worker : workers){
+        worker.join();
+    }
+}
+
+/**
+ * @brief Normalizovaná hrana (menší id první) s pozicí ve vstupním vektoru.
+ */
+struct NormalizedEdge{
+    size_t low;  ///< menší z id koncových uzlů
+    size_t high;  ///< větší z id koncových uzlů
+    size_t position;  ///< pozice hrany ve vstupu
+
+    bool operator<(const NormalizedEdge& other) const{
+        return std::tie(low, high, position) < std::tie(other.low, other.high, other.position);
+    }
+};
+
+/**
+ * @brief Seřadí vektor pomocí více vláken.
+ *
+ * Každé vlákno seřadí svou část, části se pak slévají po dvojicích, dokud nezbude jediná.
+ */
+template<typename T>
+void parallelSort(std::vector<T>& values, size_t threads){
+    size_t chunk = (values.size() + threads - 1) / threads;
+    if (threads <= 1 || chunk < 4096){
+        std::sort(values.begin(), values.end());
+        return;
+    }
+
+    parallelFor(threads, threads, [&](size_t begin, size_t end, size_t){
+        for (size_t part = begin; part < end; part++){
+            size_t from = std::min(values.size(), part * chunk);
+            std::sort(values.begin() + from, values.begin() + std::min(values.size(), from + chunk));
+        }
+    });
+
+    for (size_t width = chunk; width < values.size(); width *= 2){
+        size_t merges = (values.size() + 2 * width - 1) / (2 * width);
+        parallelFor(std::min(threads, merges), merges, [&](size_t begin, size_t end, size_t){
+            for (size_t merge = begin; merge < end; merge++){
+                size_t from = merge * 2 * width;
+                size_t middle = std::min(values.size(), from + width);
+                size_t to = std::min(values.size(), from + 2 * width);
+                std::inplace_merge(values.begin() + from, values.begin() + middle, values.begin() + to);
+            }
+        });
+    }
+}
+
+} // namespace
+
+size_t BlockPool::sizeClass(size_t bytes){
+    size_t sizeClass = 0;
+    while ((size_t(8) << sizeClass) < bytes){
+        sizeClass++;
+    }
+    return sizeClass;
+}
+
+void* BlockPool::allocate(size_t bytes){
+    size_t index = sizeClass(bytes);
+    size_t blockBytes = size_t(8) << index;
+    if (index < this->freeBlocks.size() && this->freeBlocks[index] != nullptr){
+        void* block = this->freeBlocks[index];
+        this->freeBlocks[index] = *static_cast<void**>(block);
+        return block;
+    }
+
+    // Oversized blocks get a chunk of their own, the current chunk stays in use
+    if (blockBytes > MAX_CHUNK_BYTES / 4){
+        this->chunks.emplace_back(new unsigned char[blockBytes]);
+        return this->chunks.back().get();
+    }
+
+    if (static_cast<size_t>(this->limit - this->next) < blockBytes){
+        this->chunkBytes = this->chunkBytes == 0 ? FIRST_CHUNK_BYTES : std::min(2 * this->chunkBytes, MAX_CHUNK_BYTES);
+        this->chunks.emplace_back(new unsigned char[this->chunkBytes]);
+        this->next = this->chunks.back().get();
+        this->limit = this->next + this->chunkBytes;
+    }
+
+    void* block = this->next;
+    this->next += blockBytes;
+    return block;
+}
+
+void BlockPool::deallocate(void* block, size_t bytes){
+    size_t index = sizeClass(bytes);
+    if (index >= this->freeBlocks.size()){
+        this->freeBlocks.resize(index + 1, nullptr);
+    }
+    *static_cast<void**>(block) = this->freeBlocks[index];
+    this->freeBlocks[index] = block;
+}
+
+void BlockPool::release(){
+    this->chunks.clear();
+    this->freeBlocks.clear();
+    this->chunkBytes = 0;
+    this->next = this->limit = nullptr;
+}
+
+size_t BlockPool::chunkCount() const{
+    return this->chunks.size();
+}
+
+size_t NeighborSet::findSlot(size_t id) const{
+    size_t mask = this->capacity - 1;
+    // Fibonacci hashing spreads consecutive ids over the whole table
+    size_t slot = ((id * 0x9e3779b97f4a7c15ULL) >> 32) & mask;
+    size_t firstDeleted = this->capacity;
+
+    while (this->states[slot] != FREE){
+        if (this->states[slot] == FULL && this->keys[slot] == id){
+            return slot;
+        }
+        if (this->states[slot] == DELETED && firstDeleted == this->capacity){
+            firstDeleted = slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return firstDeleted != this->capacity ? firstDeleted : slot;
+}
+
+void NeighborSet::rehash(size_t newCapacity){
+    size_t* oldKeys = this->keys;
+    size_t* oldPositions = this->positions;
+    unsigned char* oldStates = this->states;
+    size_t oldCapacity = this->capacity;
+
+    // Keys and positions share one block, states use a second one
+    this->keys = static_cast<size_t*>(this->pool->allocate(2 * newCapacity * sizeof(size_t)));
+    this->positions = this->keys + newCapacity;
+    this->states = static_cast<unsigned char*>(this->pool->allocate(newCapacity));
+    std::fill(this->states, this->states + newCapacity, FREE);
+    this->capacity = newCapacity;
+    this->deleted = 0;
+
+    for (size_t slot = 0; slot < oldCapacity; slot++){
+        if (oldStates[slot] == FULL){
+            size_t target = findSlot(oldKeys[slot]);
+            this->keys[target] = oldKeys[slot];
+            this->positions[target] = oldPositions[slot];
+            this->states[target] = FULL;
+        }
+    }
+
+    if (oldCapacity != 0){
+        this->pool->deallocate(oldKeys, 2 * oldCapacity * sizeof(size_t));
+        this->pool->deallocate(oldStates, oldCapacity);
+    }
+}
+
+void NeighborSet::release(){
+    if (this->capacity != 0){
+        this->pool->deallocate(this->keys, 2 * this->capacity * sizeof(size_t));
+        this->pool->deallocate(this->states, this->capacity);
+    }
+    this->keys = this->positions = nullptr;
+    this->states = nullptr;
+    this->capacity = this->used = this->deleted = 0;
+}
+
+size_t NeighborSet::capacityFor(size_t size){
+    // Load factor stays below 3/4
+    size_t capacity = 4;
+    while (capacity * 3 < size * 4){
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+void NeighborSet::reserve(size_t size){
+    size_t needed = capacityFor(size);
+    if (needed > this->capacity){
+        rehash(needed);
+    }
+}
+
+bool NeighborSet::insert(size_t id, size_t position){
+    // Deleted slots lengthen probing as well, rehashing drops them
+    if ((this->used + this->deleted + 1) * 4 > this->capacity * 3){
+        rehash(std::max(this->capacity, capacityFor(this->used + 1)));
+    }
+
+    size_t slot = findSlot(id);
+    if (this->states[slot] == FULL){
+        return false;
+    }
+
+    this->deleted -= this->states[slot] == DELETED;
+    this->keys[slot] = id;
+    this->positions[slot] = position;
+    this->states[slot] = FULL;
+    this->used++;
+    return true;
+}
+
+bool NeighborSet::erase(size_t id){
+    if (this->used == 0){
+        return false;
+    }
+
+    size_t slot = findSlot(id);
+    if (this->states[slot] != FULL){
+        return false;
+    }
+
+    this->states[slot] = DELETED;
+    this->used--;
+    this->deleted++;
+    return true;
+}
+
+size_t NeighborSet::count(size_t id) const{
+    return this->used != 0 && this->states[findSlot(id)] == FULL;
+}
+
+size_t* NeighborSet::findPosition(size_t id){
+    if (this->used == 0){
+        return nullptr;
+    }
+
+    size_t slot = findSlot(id);
+    return this->states[slot] == FULL ? &this->positions[slot] : nullptr;
+}
+
+namespace {
+
+char deletedEntryMarker;  ///< only its address is used
+
+} // namespace
+
+Graph::NodeEntry* const Graph::NodeIndex::DELETED = reinterpret_cast<Graph::NodeEntry*>(&deletedEntryMarker);
+
+size_t Graph::NodeIndex::findSlot(size_t id) const{
+    size_t mask = this->capacity - 1;
+    size_t slot = ((id * 0x9e3779b97f4a7c15ULL) >> 32) & mask;
+    size_t firstDeleted = this->capacity;
+
+    while (this->entries[slot] != nullptr){
+        if (this->entries[slot] != DELETED && this->keys[slot] == id){
+            return slot;
+        }
+        if (this->entries[slot] == DELETED && firstDeleted == this->capacity){
+            firstDeleted = slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return firstDeleted != this->capacity ? firstDeleted : slot;
+}
+
+void Graph::NodeIndex::rehash(size_t newCapacity){
+    std::unique_ptr<size_t[]> oldKeys = std::move(this->keys);
+    std::unique_ptr<NodeEntry*[]> oldEntries = std::move(this->entries);
+    size_t oldCapacity = this->capacity;
+
+    this->keys.reset(new size_t[newCapacity]);
+    this->entries.reset(new NodeEntry*[newCapacity]());
+    this->capacity = newCapacity;
+    this->deleted = 0;
+
+    for (size_t slot = 0; slot < oldCapacity; slot++){
+        if (occupied(oldEntries[slot])){
+            size_t target = findSlot(oldKeys[slot]);
+            this->keys[target] = oldKeys[slot];
+            this->entries[target] = oldEntries[slot];
+        }
+    }
+}
+
+Graph::NodeEntry* Graph::NodeIndex::find(size_t id) const{
+    if (this->used == 0){
+        return nullptr;
+    }
+
+    NodeEntry* entry = this->entries[findSlot(id)];
+    return occupied(entry) ? entry : nullptr;
+}
+
+Graph::NodeEntry*& Graph::NodeIndex::insert(size_t id){
+    // Deleted slots lengthen probing as well, rehashing drops them
+    if ((this->used + this->deleted + 1) * 4 > this->capacity * 3){
+        size_t newCapacity = std::max<size_t>(this->capacity, 16);
+        while (newCapacity * 3 < (this->used + 1) * 4){
+            newCapacity *= 2;
+        }
+        rehash(newCapacity);
+    }
+
+    size_t slot = findSlot(id);
+    if (!occupied(this->entries[slot])){
+        this->deleted -= this->entries[slot] == DELETED;
+        this->keys[slot] = id;
+        this->entries[slot] = nullptr;
+        this->used++;
+    }
+    return this->entries[slot];
+}
+
+void Graph::NodeIndex::erase(size_t id){
+    if (this->used == 0){
+        return;
+    }
+
+    size_t slot = findSlot(id);
+    if (occupied(this->entries[slot])){
+        this->entries[slot] = DELETED;
+        this->used--;
+        this->deleted++;
+    }
+}
+
+void Graph::NodeIndex::reserve(size_t size){
+    size_t needed = 16;
+    while (needed * 3 < size * 4){
+        needed *= 2;
+    }
+    if (needed > this->capacity){
+        rehash(needed);
+    }
+}
+
+void Graph::NodeIndex::clear(){
+    std::fill(this->entries.get(), this->entries.get() + this->capacity, nullptr);
+    this->used = this->deleted = 0;
+}
 
 Graph::Graph(){}
 
@@ -31,112 +408,228 @@ std::vector<Edge> Graph::edges() const{
     return this->gEdges;
 }
 
+Range<std::vector<Node*>::const_iterator> Graph::nodeRange() const{
+    return Range<std::vector<Node*>::const_iterator>(this->gNodes.begin(), this->gNodes.end(), this->gNodes.size());
+}
+
+Range<std::vector<Edge>::const_iterator> Graph::edgeRange() const{
+    return Range<std::vector<Edge>::const_iterator>(this->gEdges.begin(), this->gEdges.end(), this->gEdges.size());
+}
+
+Range<NeighborSet::const_iterator> Graph::neighbors(size_t nodeId) const{
+    const NodeEntry* found = this->gIndex.find(nodeId);
+
+    // Node doesn't exist
+    if (found == nullptr){
+        throw std::out_of_range("Error: (out_of_range) trying to get neighbors of node that doesn't exist\n");
+    }
+
+    const NeighborSet& set = found->neighbors;
+    return Range<NeighborSet::const_iterator>(set.begin(), set.end(), set.size());
+}
+
 Node* Graph::addNode(size_t nodeId) {
     // Check if node with given id already exists
-    for (auto node : this->gNodes){
-        if (nodeId == node->id){
-            return nullptr;
-        }
+    NodeEntry*& entry = this->gIndex.insert(nodeId);
+    if (entry != nullptr){
+        return nullptr;
     }
 
     // If not, creates a new one
-    Node* new_node = new Node();
+    entry = this->gEntries.allocate(this->gBlocks);
+    return createNode(nodeId, *entry);
+}
+
+Node* Graph::createNode(size_t nodeId, NodeEntry& entry){
+    Node* new_node = &entry.node;
     new_node->id = nodeId;
     new_node->color = 0;
+
+    entry.position = this->gNodes.size();
     this->gNodes.push_back(new_node);
+    markColorDirty(nodeId);
 
     return new_node;
 }
 
+void Graph::appendEdge(const Edge& edge, NodeEntry& entryA, NodeEntry& entryB){
+    // A new edge can only break the coloring if both ends share a color
+    if (entryA.node.color == entryB.node.color){
+        markColorDirty(edge.a);
+    }
+    entryA.neighbors.insert(edge.b, this->gEdges.size());
+    entryB.neighbors.insert(edge.a, this->gEdges.size());
+    this->gEdges.push_back(edge);
+}
+
+void Graph::eraseEdgeAt(size_t position){
+    // Lower degree may leave a color above degree + 1
+    markColorDirty(this->gEdges[position].a);
+    markColorDirty(this->gEdges[position].b);
+
+    // Move the last edge into the gap and fix its position in both neighbor sets
+    const Edge& last = this->gEdges.back();
+    if (position != this->gEdges.size() - 1){
+        *this->gIndex.find(last.a)->neighbors.findPosition(last.b) = position;
+        *this->gIndex.find(last.b)->neighbors.findPosition(last.a) = position;
+        this->gEdges[position] = last;
+    }
+    this->gEdges.pop_back();
+}
+
+Graph::NodeEntry& Graph::nodeEntry(size_t nodeId){
+    NodeEntry*& entry = this->gIndex.insert(nodeId);
+    if (entry == nullptr){
+        entry = this->gEntries.allocate(this->gBlocks);
+        createNode(nodeId, *entry);
+    }
+    return *entry;
+}
+
 bool Graph::addEdge(const Edge& edge){
     // Check for loop edge
     if (edge.a == edge.b){
         return false;
     }
 
-    // Check for duplicates
-    for (auto currEdge : this->gEdges){
-        if (currEdge == edge){
-            return false;
-        }
+    // Create nodes if they don't exist yet and check for duplicates,
+    // entries stay in place even if the index rehashes
+    NodeEntry& entryA = nodeEntry(edge.a);
+    if (entryA.neighbors.count(edge.b)){
+        return false;
     }
+    NodeEntry& entryB = nodeEntry(edge.b);
 
     // Add edge to the graph list
-    this->gEdges.push_back(edge);
-    // Create nodes if they don't exist yet
-    addNode(edge.a);
-    addNode(edge.b);
+    appendEdge(edge, entryA, entryB);
 
     return true;
 }
 
 void Graph::addMultipleEdges(const std::vector<Edge>& edges) {
-    for (size_t i = 0; i < edges.size(); i++) {
-        addEdge(edges.at(i));
+    addMultipleEdges(edges, 1);
+}
+
+void Graph::addMultipleEdges(const std::vector<Edge>& edges, size_t threads){
+    if (threads == 0){
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Normalize edges and drop loops
+    std::vector<NormalizedEdge> sorted;
+    sorted.reserve(edges.size());
+    for (size_t i = 0; i < edges.size(); i++){
+        const Edge& edge = edges[i];
+        if (edge.a != edge.b){
+            sorted.push_back({std::min(edge.a, edge.b), std::max(edge.a, edge.b), i});
+        }
+    }
+    parallelSort(sorted, threads);
+
+    // Keep the first occurrence of every edge which is not in the graph yet
+    std::vector<char> keep(edges.size(), 0);
+    std::vector<size_t> endpoints;
+    for (size_t i = 0; i < sorted.size(); i++){
+        const NormalizedEdge& edge = sorted[i];
+        bool duplicate = i > 0 && sorted[i - 1].low == edge.low && sorted[i - 1].high == edge.high;
+        if (!duplicate && (this->gIndex.empty() || !containsEdge(Edge(edge.low, edge.high)))){
+            keep[edge.position] = 1;
+            endpoints.push_back(edge.low);
+            endpoints.push_back(edge.high);
+        }
+    }
+    std::vector<NormalizedEdge>().swap(sorted);
+
+    // Number of new neighbors of every endpoint, so that each neighbor set is sized only once
+    parallelSort(endpoints, threads);
+    this->gIndex.reserve(this->gNodes.size() + endpoints.size() / 2);
+    for (size_t i = 0, run; i < endpoints.size(); i += run){
+        for (run = 1; i + run < endpoints.size() && endpoints[i + run] == endpoints[i]; run++);
+
+        NodeEntry*& entry = this->gIndex.insert(endpoints[i]);
+        if (entry == nullptr){
+            entry = this->gEntries.allocate(this->gBlocks);
+        }
+        entry->neighbors.reserve(entry->neighbors.size() + run);
+    }
+
+    // Insert in input order so that nodes and edges end up as with repeated addEdge calls,
+    // entries created above get their nodes here
+    this->gEdges.reserve(this->gEdges.size() + endpoints.size() / 2);
+    for (size_t i = 0; i < edges.size(); i++){
+        if (keep[i]){
+            const Edge& edge = edges[i];
+            NodeEntry& entryA = *this->gIndex.find(edge.a);
+            if (entryA.position == NO_POSITION){
+                createNode(edge.a, entryA);
+            }
+            NodeEntry& entryB = *this->gIndex.find(edge.b);
+            if (entryB.position == NO_POSITION){
+                createNode(edge.b, entryB);
+            }
+            appendEdge(edge, entryA, entryB);
+        }
     }
 }
 
 Node* Graph::getNode(size_t nodeId){
-    // Go through all nodes in graph list to check if given node exists
-    for(auto node : this->gNodes){
-        if (node->id == nodeId){
-            return node;
-        }
+    NodeEntry* found = this->gIndex.find(nodeId);
+    if (found != nullptr){
+        return &found->node;
     }
 
     return nullptr;
 }
 
 bool Graph::containsEdge(const Edge& edge) const{
-    // Go through all edges in graph list to check if given edge exists
-    for(auto currEdge : this->gEdges){
-        if (currEdge == edge){
-            return true;
-        }
+    const NodeEntry* found = this->gIndex.find(edge.a);
+    if (found != nullptr){
+        return found->neighbors.count(edge.b) != 0;
     }
-    
+
     return false;
 }
 
 void Graph::removeNode(size_t nodeId){
-    // Check if node exists
-    if (getNode(nodeId)){
-        // Check if node is part of any edges
-        for (long i = edgeCount() - 1; i >= 0; i--){
-            if (this->gEdges[i].a == nodeId || this->gEdges[i].b == nodeId){
-                // remove edge
-                this->gEdges.erase(this->gEdges.begin() + i);
-            }
-        }
-        // Remove node
-        for (long i = nodeCount() - 1; i >= 0; i--){
-            if (this->gNodes[i]->id == nodeId){
-                // remove node
-                delete this->gNodes[i];
-                this->gNodes.erase(this->gNodes.begin() + i);
-            }
-        }
+    NodeEntry* found = this->gIndex.find(nodeId);
 
-        return;
+    // If node doesn't exist in graph
+    if (found == nullptr){
+        throw std::out_of_range("Error: (out_of_range) trying to remove node that doesn't exist\n");
     }
 
-    // If node doesn't exist in graph
-    throw std::out_of_range("Error: (out_of_range) trying to remove node that doesn't exist\n");
+    // Remove edges of the node and disconnect it from all its neighbors, positions of the remaining
+    // edges are read only now because removing an edge may move another edge of this node
+    NeighborSet& neighbors = found->neighbors;
+    for (size_t neighbor : neighbors){
+        eraseEdgeAt(*neighbors.findPosition(neighbor));
+        this->gIndex.find(neighbor)->neighbors.erase(nodeId);
+    }
+
+    // Remove node, the last node takes its place
+    size_t position = found->position;
+    Node* last = this->gNodes.back();
+    this->gNodes[position] = last;
+    this->gIndex.find(last->id)->position = position;
+    this->gNodes.pop_back();
+    neighbors.release();
+    this->gEntries.deallocate(found);
+    this->gIndex.erase(nodeId);
 }
 
 void Graph::removeEdge(const Edge& edge){
+    NodeEntry* foundA = this->gIndex.find(edge.a);
+
     // Check if given edge exists
-    if (containsEdge(edge)){
-        for(size_t i = 0; i < edgeCount(); i++){
-            if (this->gEdges[i] == edge){
-                // remove the edge
-                this->gEdges.erase(this->gEdges.begin() + i);
-                return;
-            }
-        }
+    size_t* position = foundA == nullptr ? nullptr : foundA->neighbors.findPosition(edge.b);
+    if (position == nullptr){
+        throw std::out_of_range("Error: (out_of_range) trying to remove edge that doesn't exist\n");
     }
 
-    throw std::out_of_range("Error: (out_of_range) trying to remove edge that doesn't exist\n");
+    // remove the edge
+    eraseEdgeAt(*position);
+    foundA->neighbors.erase(edge.b);
+    this->gIndex.find(edge.b)->neighbors.erase(edge.a);
 }
 
 size_t Graph::nodeCount() const{
@@ -148,90 +641,651 @@ size_t Graph::edgeCount() const{
 }
 
 size_t Graph::nodeDegree(size_t nodeId) const{
+    const NodeEntry* found = this->gIndex.find(nodeId);
+
+    // Node doesn't exist
+    if (found == nullptr){
+        throw std::out_of_range("Error: (out_of_range) trying to get degree of node that doesn't exist\n");
+    }
 
-    Node* nodeExist = nullptr; 
-    // Check if given node exists in graph
-    for(auto node : this->gNodes){
-        if (node->id == nodeId){
-            nodeExist = node;
+    return found->neighbors.size();
+}
+
+size_t Graph::graphDegree() const{
+    size_t maxDegree = 0;
+
+    // Check degree of every node
+    for (const NodeEntry* entry : this->gIndex){
+        if (entry->neighbors.size() > maxDegree){
+            maxDegree = entry->neighbors.size();
         }
     }
 
-    // If it exists
-    if (nodeExist){
-        // Default value
-        size_t degree = 0;
+    return maxDegree;
+}
+
+void Graph::coloring(){
+    coloring(ColoringOrder::Natural);
+}
+
+void Graph::coloring(ColoringOrder order){
+    coloring(order, 1);
+}
+
+// Colors a CSR snapshot and copies the colors back to the nodes
+void Graph::coloring(ColoringOrder order, size_t threads){
+    CsrGraph snapshot(*this);
+    snapshot.coloring(order, threads);
+
+    for (size_t i = 0; i < snapshot.nodeCount(); i++){
+        this->gIndex.find(snapshot.ids[i])->node.color = snapshot.colors[i];
+    }
+    this->gColorDirty.clear();
+    this->gColoringValid = true;
+}
+
+void Graph::updateColoring(){
+    if (!this->gColoringValid){
+        coloring();
+        return;
+    }
 
-        for (auto edge : this->gEdges){
-            if (edge.a == nodeId || edge.b == nodeId){
-                degree++;
+    std::vector<char> used;
+    for (size_t nodeId : this->gColorDirty){
+        NodeEntry* found = this->gIndex.find(nodeId);
+        // Node was removed after being marked
+        if (found == nullptr){
+            continue;
+        }
+
+        Node* node = &found->node;
+        size_t degree = found->neighbors.size();
+        used.assign(degree + 2, 0);
+        bool conflict = node->color == 0 || node->color > degree + 1;
+        for (size_t neighbor : found->neighbors){
+            size_t color = this->gIndex.find(neighbor)->node.color;
+            conflict = conflict || color == node->color;
+            if (color <= degree + 1){
+                used[color] = 1;
+            }
+        }
+
+        // Smallest color unused by the neighbors is at most degree + 1
+        if (conflict){
+            size_t color = 1;
+            while (used[color]){
+                color++;
             }
+            node->color = color;
         }
-        return degree;
     }
+    this->gColorDirty.clear();
+}
 
-    // Node doesn't exist
-    throw std::out_of_range("Error: (out_of_range) trying to remove edge that doesn't exist\n");
-    return 0;
+void Graph::markColorDirty(size_t nodeId){
+    if (this->gColoringValid){
+        this->gColorDirty.push_back(nodeId);
+        // Past this point full coloring is cheaper than the repair
+        if (this->gColorDirty.size() > this->gNodes.size() + this->gEdges.size()){
+            this->gColoringValid = false;
+            std::vector<size_t>().swap(this->gColorDirty);
+        }
+    }
 }
 
-size_t Graph::graphDegree() const{
-    // Go through all nodes in graph list
-    size_t maxDegree = 0;
-    size_t currDegree = 0;
+void Graph::clear() {
+    // Nodes and neighbor arrays are released at once together with their chunks,
+    // the index keeps its capacity for the next graph
+    this->gNodes.clear();
+    this->gEdges.clear();
+    this->gIndex.clear();
+    this->gEntries.release();
+    this->gBlocks.release();
+    this->gColorDirty.clear();
+    this->gColoringValid = false;
+}
 
-    // Check degree of every node
-    for(Node* node : this->gNodes){
-        currDegree = nodeDegree(node->id);
+namespace {
+
+/**
+ * @brief Hladové barvení uzlů v daném pořadí.
+ *
+ * Barvy sousedů se značí do pole forbidden hodnotou kroku, ve kterém se barví daný uzel, takže pole
+ * není nutné mezi uzly nulovat. Uzel dostane nejmenší barvu nepoužitou sousedy, tedy nejvýše stupeň + 1.
+ */
+void greedyColoring(const size_t* offsets, const size_t* neighbors, const std::vector<size_t>& order,
+                    size_t maxDegree, size_t* colors){
+    std::vector<size_t> forbidden(maxDegree + 2, order.size());
+
+    for (size_t step = 0; step < order.size(); step++){
+        size_t node = order[step];
+        for (size_t k = offsets[node]; k < offsets[node + 1]; k++){
+            forbidden[colors[neighbors[k]]] = step;
+        }
 
-        if (currDegree > maxDegree){
-            maxDegree = currDegree;
+        // Find the smallest available color
+        size_t color = 1;
+        while (forbidden[color] == step){
+            color++;
         }
+        colors[node] = color;
     }
+}
 
-    return maxDegree;
+// Nodes sorted by degree in descending order (counting sort)
+std::vector<size_t> largestFirstOrder(const size_t* offsets, size_t nodeCount, size_t maxDegree){
+    std::vector<size_t> start(maxDegree + 2, 0);
+    for (size_t node = 0; node < nodeCount; node++){
+        start[maxDegree - (offsets[node + 1] - offsets[node]) + 1]++;
+    }
+    for (size_t d = 1; d < start.size(); d++){
+        start[d] += start[d - 1];
+    }
+
+    std::vector<size_t> order(nodeCount);
+    for (size_t node = 0; node < nodeCount; node++){
+        order[start[maxDegree - (offsets[node + 1] - offsets[node])]++] = node;
+    }
+    return order;
 }
 
-// Using simple greedy coloring
-void Graph::coloring(){
-    for (auto node : this->gNodes){
-        std::unordered_set<size_t> usedColors;
-
-        // Check colors of adjacent nodes
-        for (auto edge : this->gEdges){
-            if (edge.a == node->id){
-                Node* neighbor = getNode(edge.b);
-                if (neighbor){
-                    usedColors.insert(neighbor->color);
-                }
-            }
+/**
+ * @brief Degenerační pořadí (smallest-last).
+ *
+ * Uzly jsou přihrádkově seřazeny podle aktuálního stupně a opakovaně je odebírán uzel s nejmenším stupněm
+ * (algoritmus Batagelj–Zaveršnik). Barví se v opačném pořadí, než byly uzly odebrány.
+ */
+std::vector<size_t> smallestLastOrder(const size_t* offsets, const size_t* neighbors, size_t nodeCount,
+                                      size_t maxDegree){
+    std::vector<size_t> degree(nodeCount);
+    std::vector<size_t> bin(maxDegree + 1, 0);
+    for (size_t node = 0; node < nodeCount; node++){
+        degree[node] = offsets[node + 1] - offsets[node];
+        bin[degree[node]]++;
+    }
+
+    // bin[d] is the first position of nodes with degree d in vert
+    size_t position = 0;
+    for (size_t d = 0; d <= maxDegree; d++){
+        size_t count = bin[d];
+        bin[d] = position;
+        position += count;
+    }
+
+    std::vector<size_t> vert(nodeCount);
+    std::vector<size_t> pos(nodeCount);
+    for (size_t node = 0; node < nodeCount; node++){
+        pos[node] = bin[degree[node]]++;
+        vert[pos[node]] = node;
+    }
+    for (size_t d = maxDegree; d > 0; d--){
+        bin[d] = bin[d - 1];
+    }
+    if (!bin.empty()){
+        bin[0] = 0;
+    }
 
-            if (edge.b == node->id) {
-                Node* neighbor = getNode(edge.a);
-                if (neighbor) {
-                    usedColors.insert(neighbor->color);
+    for (size_t i = 0; i < nodeCount; i++){
+        size_t node = vert[i];
+        for (size_t k = offsets[node]; k < offsets[node + 1]; k++){
+            size_t neighbor = neighbors[k];
+            if (degree[neighbor] > degree[node]){
+                // Move neighbor to the front of its bin and shrink the bin
+                size_t neighborDegree = degree[neighbor];
+                size_t first = vert[bin[neighborDegree]];
+                if (first != neighbor){
+                    std::swap(vert[pos[neighbor]], vert[bin[neighborDegree]]);
+                    std::swap(pos[neighbor], pos[first]);
                 }
+                bin[neighborDegree]++;
+                degree[neighbor]--;
             }
         }
+    }
 
-        // Find the smallest available color
+    std::reverse(vert.begin(), vert.end());
+    return vert;
+}
+
+/**
+ * @brief Barvení DSatur.
+ *
+ * Vždy je obarven neobarvený uzel s nejvyšší saturací (počtem různých barev sousedů), při shodě s vyšším
+ * stupněm. Fronta uzlů je uspořádaná množina, proto je složitost O((V + E) log V).
+ */
+void dsaturColoring(const size_t* offsets, const size_t* neighbors, size_t nodeCount, size_t maxDegree,
+                    size_t* colors){
+    std::vector<std::unordered_set<size_t>> neighborColors(nodeCount);
+    // (saturation, degree, node), the last element is colored next
+    std::set<std::tuple<size_t, size_t, size_t>> queue;
+    for (size_t node = 0; node < nodeCount; node++){
+        queue.emplace(0, offsets[node + 1] - offsets[node], nodeCount - 1 - node);
+    }
+
+    std::vector<size_t> forbidden(maxDegree + 2, nodeCount);
+    while (!queue.empty()){
+        auto next = std::prev(queue.end());
+        size_t node = nodeCount - 1 - std::get<2>(*next);
+        queue.erase(next);
+
+        for (size_t k = offsets[node]; k < offsets[node + 1]; k++){
+            forbidden[colors[neighbors[k]]] = node;
+        }
         size_t color = 1;
-        while (usedColors.count(color)) {
+        while (forbidden[color] == node){
             color++;
         }
+        colors[node] = color;
 
-        // Assign the color to the node
-        node->color = color;
+        // Update saturation of uncolored neighbors
+        for (size_t k = offsets[node]; k < offsets[node + 1]; k++){
+            size_t neighbor = neighbors[k];
+            if (colors[neighbor] == 0 && neighborColors[neighbor].insert(color).second){
+                size_t degree = offsets[neighbor + 1] - offsets[neighbor];
+                size_t saturation = neighborColors[neighbor].size();
+                queue.erase(std::make_tuple(saturation - 1, degree, nodeCount - 1 - neighbor));
+                queue.emplace(saturation, degree, nodeCount - 1 - neighbor);
+            }
+        }
     }
 }
 
-void Graph::clear() {
-    for (auto node : this->gNodes){
-        delete node;
+/**
+ * @brief Paralelní spekulativní barvení s opravou konfliktů.
+ *
+ * Vlákna barví souvislé části pořadí hladově. Barvy uzlů z vlastní části vidí hned, barvy uzlů ostatních
+ * vláken jen z předchozího kola, výsledek proto nezávisí na plánování vláken a vlákna se nepřekrývají
+ * v zápisech ani čtení. Následně se paralelně hledají konflikty: ze sousedů se stejnou barvou je přebarven
+ * ten s vyšším indexem. Přebarvení probíhá stejně, dokud konflikty nezmizí. Uzel s nejmenším indexem mezi
+ * přebarvovanými má všechny menší sousedy ustálené, každé kolo tedy alespoň jeden konflikt vyřeší. Každý
+ * uzel dostane nejmenší barvu, kterou neviděl u sousedů, tedy nejvýše stupeň + 1.
+ */
+void speculativeColoring(const size_t* offsets, const size_t* neighbors, size_t nodeCount,
+                         std::vector<size_t> pending, size_t maxDegree, size_t threads, size_t* colors){
+    std::fill(colors, colors + nodeCount, 0);
+    std::vector<size_t> tentative(nodeCount, 0);
+    std::vector<size_t> owner(nodeCount, threads);
+    std::vector<std::vector<size_t>> forbidden(threads, std::vector<size_t>(maxDegree + 2, 0));
+    std::vector<size_t> stamps(threads, 0);
+    std::vector<std::vector<size_t>> conflicts(threads);
+
+    while (!pending.empty()){
+        parallelFor(threads, pending.size(), [&](size_t begin, size_t end, size_t thread){
+            for (size_t i = begin; i < end; i++){
+                owner[pending[i]] = thread;
+                tentative[pending[i]] = 0;
+            }
+        });
+
+        parallelFor(threads, pending.size(), [&](size_t begin, size_t end, size_t thread){
+            std::vector<size_t>& used = forbidden[thread];
+            for (size_t i = begin; i < end; i++){
+                size_t node = pending[i];
+                // Fresh stamp per visit, so marks from earlier rounds never count as forbidden
+                size_t stamp = ++stamps[thread];
+                for (size_t k = offsets[node]; k < offsets[node + 1]; k++){
+                    size_t neighbor = neighbors[k];
+                    used[owner[neighbor] == thread ? tentative[neighbor] : colors[neighbor]] = stamp;
+                }
+                size_t color = 1;
+                while (used[color] == stamp){
+                    color++;
+                }
+                tentative[node] = color;
+            }
+        });
+
+        parallelFor(threads, pending.size(), [&](size_t begin, size_t end, size_t){
+            for (size_t i = begin; i < end; i++){
+                colors[pending[i]] = tentative[pending[i]];
+                owner[pending[i]] = threads;
+            }
+        });
+
+        parallelFor(threads, pending.size(), [&](size_t begin, size_t end, size_t thread){
+            for (size_t i = begin; i < end; i++){
+                size_t node = pending[i];
+                for (size_t k = offsets[node]; k < offsets[node + 1]; k++){
+                    size_t neighbor = neighbors[k];
+                    if (neighbor < node && colors[neighbor] == colors[node]){
+                        conflicts[thread].push_back(node);
+                        break;
+                    }
+                }
+            }
+        });
+
+        pending.clear();
+        for (auto& part : conflicts){
+            pending.insert(pending.end(), part.begin(), part.end());
+            part.clear();
+        }
     }
+}
 
-    this->gNodes.clear();
-    this->gEdges.clear();
+} // namespace
+
+CsrGraph Graph::freeze() const{
+    return CsrGraph(*this);
+}
+
+void Graph::save(const std::string& path) const{
+    freeze().save(path);
+}
+
+void Graph::load(const std::string& path){
+    CsrGraph snapshot = CsrGraph::load(path);
+    clear();
+
+    // Entries are created in dense order, neighbor sets get their final size at once
+    std::vector<NodeEntry*> entries(snapshot.nodeCount());
+    this->gIndex.reserve(snapshot.nodeCount());
+    this->gNodes.reserve(snapshot.nodeCount());
+    for (size_t i = 0; i < snapshot.nodeCount(); i++){
+        NodeEntry*& slot = this->gIndex.insert(snapshot.ids[i]);
+        slot = this->gEntries.allocate(this->gBlocks);
+        NodeEntry& entry = *slot;
+        createNode(snapshot.ids[i], entry)->color = snapshot.colors[i];
+        entry.neighbors.reserve(snapshot.offsets[i + 1] - snapshot.offsets[i]);
+        entries[i] = &entry;
+    }
+
+    this->gEdges.reserve(snapshot.edgeCount());
+    for (size_t i = 0; i < snapshot.nodeCount(); i++){
+        for (size_t k = snapshot.offsets[i]; k < snapshot.offsets[i + 1]; k++){
+            size_t neighbor = snapshot.neighbors[k];
+            // Every edge is stored for both endpoints, add it once
+            if (neighbor > i){
+                appendEdge(Edge(snapshot.ids[i], snapshot.ids[neighbor]), *entries[i], *entries[neighbor]);
+            }
+        }
+    }
+}
+
+CsrGraph::CsrGraph(const Graph& graph){
+    allocate(graph.nodeCount(), 2 * graph.edgeCount());
+
+    // Dense renumbering in ascending id order
+    size_t i = 0;
+    for (const Graph::NodeEntry* entry : graph.gIndex){
+        this->ids[i++] = entry->node.id;
+    }
+    std::sort(this->ids, this->ids + this->nodes);
+
+    std::unordered_map<size_t, size_t> denseIndex;
+    denseIndex.reserve(this->nodes);
+    for (i = 0; i < this->nodes; i++){
+        denseIndex.emplace(this->ids[i], i);
+    }
+
+    // Each edge is stored once for every endpoint
+    this->offsets[0] = 0;
+    for (i = 0; i < this->nodes; i++){
+        const Graph::NodeEntry& entry = *graph.gIndex.find(this->ids[i]);
+        size_t* list = this->neighbors + this->offsets[i];
+        size_t degree = 0;
+        for (size_t neighbor : entry.neighbors){
+            list[degree++] = denseIndex.find(neighbor)->second;
+        }
+        // Sorted neighbor lists keep traversals close to sequential
+        std::sort(list, list + degree);
+        this->offsets[i + 1] = this->offsets[i] + degree;
+        this->colors[i] = entry.node.color;
+    }
+}
+
+CsrGraph::CsrGraph(CsrGraph&& other) noexcept{
+    *this = std::move(other);
+}
+
+CsrGraph& CsrGraph::operator=(CsrGraph&& other) noexcept{
+    if (this != &other){
+        release();
+        std::swap(this->buffer, other.buffer);
+        std::swap(this->bufferBytes, other.bufferBytes);
+        std::swap(this->mapped, other.mapped);
+        std::swap(this->nodes, other.nodes);
+        std::swap(this->neighborCount, other.neighborCount);
+        std::swap(this->ids, other.ids);
+        std::swap(this->offsets, other.offsets);
+        std::swap(this->neighbors, other.neighbors);
+        std::swap(this->colors, other.colors);
+    }
+    return *this;
+}
+
+CsrGraph::~CsrGraph(){
+    release();
+}
+
+void CsrGraph::allocate(size_t nodeCount, size_t neighborCount){
+    size_t words = CSR_HEADER_WORDS + 3 * nodeCount + 1 + neighborCount;
+    this->buffer = new size_t[words]();
+    this->bufferBytes = words * sizeof(size_t);
+    this->mapped = false;
+    // Header is filled once here, save() then writes the buffer as is
+    this->buffer[0] = CSR_FILE_MAGIC;
+    this->buffer[1] = nodeCount;
+    this->buffer[2] = neighborCount;
+    setLayout(nodeCount, neighborCount);
+}
+
+void CsrGraph::setLayout(size_t nodeCount, size_t neighborCount){
+    this->nodes = nodeCount;
+    this->neighborCount = neighborCount;
+    this->ids = this->buffer + CSR_HEADER_WORDS;
+    this->offsets = this->ids + nodeCount;
+    this->neighbors = this->offsets + nodeCount + 1;
+    this->colors = this->neighbors + neighborCount;
+}
+
+void CsrGraph::release(){
+    if (this->mapped){
+#ifdef TDD_CODE_MMAP
+        munmap(this->buffer, this->bufferBytes);
+#endif
+    }
+    else{
+        delete[] this->buffer;
+    }
+
+    this->buffer = this->ids = this->offsets = this->neighbors = this->colors = nullptr;
+    this->bufferBytes = this->nodes = this->neighborCount = 0;
+    this->mapped = false;
+}
+
+void CsrGraph::save(const std::string& path) const{
+    if (this->buffer == nullptr){
+        // Empty snapshot, write at least the header
+        CsrGraph empty;
+        empty.allocate(0, 0);
+        empty.save(path);
+        return;
+    }
+
+    // Written aside and renamed over the target, truncating path in place would pull the pages
+    // from under a snapshot mapped from that same file
+    std::string temporary = path + ".tmp";
+    bool written;
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(this->buffer), this->bufferBytes);
+        file.close();
+        written = !file.fail();
+    }
+    if (!written || std::rename(temporary.c_str(), path.c_str()) != 0){
+        std::remove(temporary.c_str());
+        throw std::runtime_error("Error: (runtime_error) unable to write graph file " + path + "\n");
+    }
+}
+
+CsrGraph CsrGraph::load(const std::string& path){
+    CsrGraph snapshot;
+    size_t header[CSR_HEADER_WORDS] = {};
+
+#ifdef TDD_CODE_MMAP
+    int file = open(path.c_str(), O_RDONLY);
+    struct stat info;
+    if (file < 0 || fstat(file, &info) != 0){
+        if (file >= 0){
+            close(file);
+        }
+        throw std::runtime_error("Error: (runtime_error) unable to open graph file " + path + "\n");
+    }
+
+    size_t bytes = info.st_size;
+    void* memory = bytes >= sizeof(header)
+                 ? mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0) : MAP_FAILED;
+    close(file);
+    if (memory != MAP_FAILED){
+        // Private mapping, coloring the snapshot never writes to the file
+        snapshot.buffer = static_cast<size_t*>(memory);
+        snapshot.bufferBytes = bytes;
+        snapshot.mapped = true;
+        std::copy(snapshot.buffer, snapshot.buffer + CSR_HEADER_WORDS, header);
+    }
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    size_t bytes = file ? static_cast<size_t>(file.tellg()) : 0;
+    if (file && bytes >= sizeof(header) && bytes % sizeof(size_t) == 0){
+        snapshot.buffer = new size_t[bytes / sizeof(size_t)];
+        snapshot.bufferBytes = bytes;
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(snapshot.buffer), bytes);
+        std::copy(snapshot.buffer, snapshot.buffer + CSR_HEADER_WORDS, header);
+    }
+#endif
+
+    size_t nodeCount = header[1];
+    size_t neighborCount = header[2];
+    // Counts bounded by the file size first, so the expected size below cannot overflow
+    size_t words = bytes / sizeof(size_t);
+    bool valid = snapshot.buffer != nullptr && header[0] == CSR_FILE_MAGIC && nodeCount <= words &&
+                 neighborCount <= words &&
+                 bytes == (CSR_HEADER_WORDS + 3 * nodeCount + 1 + neighborCount) * sizeof(size_t);
+
+    if (valid){
+        snapshot.setLayout(nodeCount, neighborCount);
+        // Every later lookup trusts these arrays, a corrupted file must not get past here
+        valid = snapshot.offsets[0] == 0 && snapshot.offsets[nodeCount] == neighborCount;
+        for (size_t i = 0; valid && i < nodeCount; i++){
+            valid = snapshot.offsets[i] <= snapshot.offsets[i + 1] &&
+                    (i == 0 || snapshot.ids[i - 1] < snapshot.ids[i]);
+        }
+        // Lists strictly increasing without self-loops, every edge stored for both endpoints
+        for (size_t i = 0; valid && i < nodeCount; i++){
+            const size_t* begin = snapshot.neighbors + snapshot.offsets[i];
+            const size_t* end = snapshot.neighbors + snapshot.offsets[i + 1];
+            for (const size_t* k = begin; valid && k != end; k++){
+                size_t neighbor = *k;
+                valid = neighbor < nodeCount && neighbor != i && (k == begin || *(k - 1) < neighbor);
+                valid = valid && std::binary_search(snapshot.neighbors + snapshot.offsets[neighbor],
+                                                    snapshot.neighbors + snapshot.offsets[neighbor + 1], i);
+            }
+        }
+    }
+    if (!valid){
+        throw std::runtime_error("Error: (runtime_error) invalid graph file " + path + "\n");
+    }
+    return snapshot;
+}
+
+size_t CsrGraph::nodeCount() const{
+    return this->nodes;
+}
+
+size_t CsrGraph::edgeCount() const{
+    return this->neighborCount / 2;
+}
+
+size_t CsrGraph::nodeIndex(size_t nodeId) const{
+    const size_t* found = std::lower_bound(this->ids, this->ids + this->nodes, nodeId);
+    if (found == this->ids + this->nodes || *found != nodeId){
+        throw std::out_of_range("Error: (out_of_range) node doesn't exist in snapshot\n");
+    }
+    return found - this->ids;
+}
+
+size_t CsrGraph::nodeId(size_t index) const{
+    if (index >= this->nodes){
+        throw std::out_of_range("Error: (out_of_range) node index out of snapshot\n");
+    }
+    return this->ids[index];
+}
+
+size_t CsrGraph::nodeDegree(size_t nodeId) const{
+    size_t index = nodeIndex(nodeId);
+    return this->offsets[index + 1] - this->offsets[index];
+}
+
+size_t CsrGraph::graphDegree() const{
+    size_t maxDegree = 0;
+    for (size_t i = 0; i < this->nodes; i++){
+        maxDegree = std::max(maxDegree, this->offsets[i + 1] - this->offsets[i]);
+    }
+    return maxDegree;
+}
+
+void CsrGraph::coloring(ColoringOrder order){
+    if (this->nodes == 0){
+        return;
+    }
+
+    size_t maxDegree = graphDegree();
+    std::fill(this->colors, this->colors + this->nodes, 0);
+
+    switch (order){
+        case ColoringOrder::Natural: {
+            std::vector<size_t> natural(this->nodes);
+            std::iota(natural.begin(), natural.end(), 0);
+            greedyColoring(this->offsets, this->neighbors, natural, maxDegree, this->colors);
+            break;
+        }
+        case ColoringOrder::LargestFirst:
+            greedyColoring(this->offsets, this->neighbors, largestFirstOrder(this->offsets, this->nodes, maxDegree),
+                           maxDegree, this->colors);
+            break;
+        case ColoringOrder::SmallestLast:
+            greedyColoring(this->offsets, this->neighbors,
+                           smallestLastOrder(this->offsets, this->neighbors, this->nodes, maxDegree), maxDegree,
+                           this->colors);
+            break;
+        case ColoringOrder::DSatur:
+            dsaturColoring(this->offsets, this->neighbors, this->nodes, maxDegree, this->colors);
+            break;
+    }
+}
+
+void CsrGraph::coloring(ColoringOrder order, size_t threads){
+    if (threads == 0){
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // DSatur picks every node based on all previous choices and stays sequential
+    if (threads == 1 || order == ColoringOrder::DSatur || this->nodes == 0){
+        coloring(order);
+        return;
+    }
+
+    size_t maxDegree = graphDegree();
+    std::vector<size_t> visitOrder;
+    switch (order){
+        case ColoringOrder::LargestFirst:
+            visitOrder = largestFirstOrder(this->offsets, this->nodes, maxDegree);
+            break;
+        case ColoringOrder::SmallestLast:
+            visitOrder = smallestLastOrder(this->offsets, this->neighbors, this->nodes, maxDegree);
+            break;
+        default:
+            visitOrder.resize(this->nodes);
+            std::iota(visitOrder.begin(), visitOrder.end(), 0);
+            break;
+    }
+    speculativeColoring(this->offsets, this->neighbors, this->nodes, std::move(visitOrder), maxDegree, threads,
+                        this->colors);
+}
+
+size_t CsrGraph::color(size_t nodeId) const{
+    return this->colors[nodeIndex(nodeId)];
 }
 
 /*** Konec souboru tdd_code.cpp ***/
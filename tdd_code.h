@@ -22,8 +22,16 @@
 #include <stdexcept>
 #include <iostream>
 #include <unordered_set>
+#include <unordered_map>
+#include <memory>
+#include <iterator>
+#include <string>
 
 // Místo pro Vaše případné includy, používejte pouze standardní knihovnu tak, aby nebylo nutno upravovat CMake.
+#include <algorithm>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 /**
  * @brief reprezentace uzlu
@@ -81,6 +89,344 @@ public:
     }
 };
 
+/**
+ * @brief Alokátor objektů jednoho typu po blocích.
+ *
+ * Objekty jsou přidělovány z bloků, jejichž velikost roste geometricky až do pevné meze, takže adresy objektů
+ * zůstávají po celou dobu jejich života stejné. Uvolněné objekty jsou znovu použity při dalším přidělení,
+ * release() uvolní všechny objekty najednou vrácením bloků. Destruktory se nevolají, typ proto musí mít
+ * triviální destruktor.
+ */
+template<typename T>
+class ChunkPool{
+    static_assert(std::is_trivially_destructible<T>::value, "release() doesn't destroy objects one by one");
+
+public:
+
+    /**
+     * @brief konstruktor prázdného alokátoru
+     */
+    ChunkPool() = default;
+
+    ChunkPool(const ChunkPool&) = delete;
+    ChunkPool& operator=(const ChunkPool&) = delete;
+
+    /**
+     * @param[in] args argumenty konstruktoru objektu
+     * @return ukazatel na nový objekt zkonstruovaný z daných argumentů
+     */
+    template<typename... Args>
+    T* allocate(Args&&... args){
+        void* memory;
+        // Reuse returned objects first
+        if (!this->freeObjects.empty()){
+            memory = this->freeObjects.back();
+            this->freeObjects.pop_back();
+        }
+        else{
+            if (this->chunkUsed == this->chunkSize){
+                this->chunkSize = this->chunks.empty() ? FIRST_CHUNK_SIZE : std::min(2 * this->chunkSize, MAX_CHUNK_SIZE);
+                this->chunks.emplace_back(new Storage[this->chunkSize]);
+                this->chunkUsed = 0;
+            }
+            memory = &this->chunks.back()[this->chunkUsed++];
+        }
+        return new (memory) T(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Vrátí objekt alokátoru k dalšímu použití.
+     * @param[in] object objekt přidělený tímto alokátorem
+     */
+    void deallocate(T* object){
+        this->freeObjects.push_back(object);
+    }
+
+    /**
+     * @brief Uvolní všechny přidělené objekty, dříve vrácené ukazatele přestávají být platné.
+     */
+    void release(){
+        this->chunks.clear();
+        this->freeObjects.clear();
+        this->chunkSize = 0;
+        this->chunkUsed = 0;
+    }
+
+    /**
+     * @return počet alokovaných bloků
+     */
+    size_t chunkCount() const { return this->chunks.size(); }
+
+private:
+    static constexpr size_t FIRST_CHUNK_SIZE = 64;  ///< počet objektů v prvním bloku
+    static constexpr size_t MAX_CHUNK_SIZE = 65536;  ///< maximální počet objektů v bloku
+
+    /// neinicializované místo pro jeden objekt
+    struct Storage{
+        alignas(T) unsigned char bytes[sizeof(T)];
+    };
+
+    std::vector<std::unique_ptr<Storage[]>> chunks;  ///< bloky objektů
+    size_t chunkSize = 0;  ///< velikost posledního bloku
+    size_t chunkUsed = 0;  ///< počet přidělených objektů z posledního bloku
+    std::vector<T*> freeObjects;  ///< vrácené objekty připravené k opětovnému použití
+};
+
+/**
+ * @brief Alokátor uzlů grafu po blocích.
+ */
+using NodePool = ChunkPool<Node>;
+
+/**
+ * @brief Alokátor paměťových bloků velikostí mocnin dvou z velkých společných úseků.
+ *
+ * Slouží polím, jejichž velikost se mění, například polím množin sousedů. Bloky se odebírají postupně
+ * z úseků, vrácený blok se zařadí do seznamu volných bloků své velikosti a použije se znovu. Úseky rostou
+ * geometricky, release() je všechny uvolní najednou bez ohledu na počet přidělených bloků.
+ */
+class BlockPool{
+public:
+
+    /**
+     * @brief konstruktor prázdného alokátoru
+     */
+    BlockPool() = default;
+
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    /**
+     * @param[in] bytes požadovaná velikost, zaokrouhlí se nahoru na mocninu dvou, nejméně na 8 bajtů
+     * @return neinicializovaný blok zarovnaný na 8 bajtů
+     */
+    void* allocate(size_t bytes);
+
+    /**
+     * @brief Vrátí blok alokátoru k dalšímu použití.
+     * @param[in] block blok přidělený tímto alokátorem
+     * @param[in] bytes velikost zadaná při přidělení bloku
+     */
+    void deallocate(void* block, size_t bytes);
+
+    /**
+     * @brief Uvolní všechny přidělené bloky, dříve vrácené ukazatele přestávají být platné.
+     */
+    void release();
+
+    /**
+     * @return počet alokovaných úseků
+     */
+    size_t chunkCount() const;
+
+private:
+    static constexpr size_t FIRST_CHUNK_BYTES = 4096;  ///< velikost prvního úseku
+    static constexpr size_t MAX_CHUNK_BYTES = 1 << 20;  ///< maximální velikost úseku, větší bloky mají vlastní
+
+    /**
+     * @param[in] bytes požadovaná velikost
+     * @return index třídy velikosti, blok třídy k má 8 << k bajtů
+     */
+    static size_t sizeClass(size_t bytes);
+
+    std::vector<std::unique_ptr<unsigned char[]>> chunks;  ///< úseky paměti
+    size_t chunkBytes = 0;  ///< velikost posledního běžného úseku
+    unsigned char* next = nullptr;  ///< první nepřidělený bajt posledního úseku
+    unsigned char* limit = nullptr;  ///< konec posledního úseku
+    std::vector<void*> freeBlocks;  ///< hlavy seznamů volných bloků podle třídy, blok ukazuje na další
+};
+
+/**
+ * @brief Množina id sousedů uzlu s otevřenou adresací.
+ *
+ * Id jsou uložena v jediném poli s lineárním sondováním, stav každé pozice (volná, obsazená, smazaná) je
+ * v samostatném poli bajtů, takže množina může obsahovat libovolné id. Oproti std::unordered_set nealokuje
+ * paměť pro každý prvek zvlášť a procházení sousedů čte paměť sekvenčně. Ke každému sousedovi je uložena
+ * pozice společné hrany v seznamu hran grafu, aby hranu šlo odebrat v konstantním čase.
+ *
+ * Pole přiděluje daný BlockPool, množina je proto nekopírovatelná a nemá destruktor. Paměť vrátí release(),
+ * nebo ji uvolní release() alokátoru společně s pamětí ostatních množin.
+ */
+class NeighborSet{
+public:
+
+    /**
+     * @brief Iterátor přes prvky množiny v libovolném pořadí.
+     */
+    class const_iterator{
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = size_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const size_t*;
+        using reference = const size_t&;
+
+        const_iterator(const NeighborSet* set, size_t slot) : set(set), slot(slot) { skipFree(); }
+
+        reference operator*() const { return set->keys[slot]; }
+
+        const_iterator& operator++(){
+            slot++;
+            skipFree();
+            return *this;
+        }
+
+        bool operator==(const const_iterator& other) const { return slot == other.slot; }
+        bool operator!=(const const_iterator& other) const { return slot != other.slot; }
+
+    private:
+        void skipFree(){
+            while (slot < set->capacity && set->states[slot] != FULL){
+                slot++;
+            }
+        }
+
+        const NeighborSet* set;
+        size_t slot;
+    };
+
+    /**
+     * @brief konstruktor prázdné množiny
+     * @param[in] pool alokátor polí množiny, musí existovat po celou dobu života množiny
+     */
+    explicit NeighborSet(BlockPool& pool) : pool(&pool) { }
+
+    NeighborSet(const NeighborSet&) = delete;
+    NeighborSet& operator=(const NeighborSet&) = delete;
+
+    /**
+     * @brief Vloží id do množiny.
+     * @param[in] id id sousedního uzlu
+     * @param[in] position pozice hrany mezi uzlem a sousedem v seznamu hran grafu
+     * @return true pokud bylo id vloženo, false pokud již v množině bylo (pozice se nemění)
+     */
+    bool insert(size_t id, size_t position);
+
+    /**
+     * @brief Odebere id z množiny.
+     * @param[in] id id sousedního uzlu
+     * @return true pokud bylo id odebráno, false pokud v množině nebylo
+     */
+    bool erase(size_t id);
+
+    /**
+     * @param[in] id id sousedního uzlu
+     * @return 1 pokud množina obsahuje id, jinak 0
+     */
+    size_t count(size_t id) const;
+
+    /**
+     * @param[in] id id sousedního uzlu
+     * @return ukazatel na uloženou pozici hrany, nullptr pokud množina id neobsahuje
+     */
+    size_t* findPosition(size_t id);
+
+    /**
+     * @brief Připraví místo pro daný počet prvků, aby další vkládání nemuselo realokovat.
+     * @param[in] size požadovaný počet prvků
+     */
+    void reserve(size_t size);
+
+    /**
+     * @brief Vrátí pole alokátoru a vyprázdní množinu.
+     */
+    void release();
+
+    /**
+     * @return počet prvků množiny
+     */
+    size_t size() const { return used; }
+
+    /**
+     * @return true pokud je množina prázdná
+     */
+    bool empty() const { return used == 0; }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, capacity); }
+
+private:
+    static constexpr unsigned char FREE = 0;  ///< pozice nebyla nikdy obsazena
+    static constexpr unsigned char FULL = 1;  ///< pozice obsahuje prvek
+    static constexpr unsigned char DELETED = 2;  ///< prvek byl z pozice odebrán
+
+    /**
+     * @brief Najde pozici prvku, případně první volnou pozici jeho sondovací posloupnosti.
+     * @param[in] id hledané id
+     * @return pozice v poli keys
+     */
+    size_t findSlot(size_t id) const;
+
+    /**
+     * @param[in] size počet prvků
+     * @return nejmenší kapacita, při které zaplnění nepřekročí 3/4
+     */
+    static size_t capacityFor(size_t size);
+
+    /**
+     * @brief Přesune prvky do polí o nové kapacitě a zahodí smazané pozice.
+     * @param[in] newCapacity nová kapacita, mocnina dvou
+     */
+    void rehash(size_t newCapacity);
+
+    BlockPool* pool;  ///< alokátor polí
+    size_t* keys = nullptr;  ///< uložená id, za nimi v témže bloku pozice hran
+    size_t* positions = nullptr;  ///< pozice hran k uloženým id
+    unsigned char* states = nullptr;  ///< stav jednotlivých pozic
+    size_t capacity = 0;  ///< počet pozic, 0 nebo mocnina dvou
+    size_t used = 0;  ///< počet prvků
+    size_t deleted = 0;  ///< počet smazaných pozic
+};
+
+/**
+ * @brief Nevlastnící pohled na posloupnost prvků daný dvojicí iterátorů.
+ *
+ * Pohled nic nekopíruje a lze ho použít v range-for. Platí jen do další změny kontejneru, nad kterým vznikl.
+ */
+template<typename Iterator>
+class Range{
+public:
+
+    /**
+     * @brief Vytvoří pohled na prvky first .. last.
+     * @param[in] first iterátor na první prvek
+     * @param[in] last iterátor za poslední prvek
+     * @param[in] count počet prvků mezi first a last
+     */
+    Range(Iterator first, Iterator last, size_t count) : first(first), last(last), count(count) { }
+
+    Iterator begin() const { return first; }
+    Iterator end() const { return last; }
+
+    /**
+     * @return počet prvků pohledu
+     */
+    size_t size() const { return count; }
+
+    /**
+     * @return true pokud pohled neobsahuje žádný prvek
+     */
+    bool empty() const { return count == 0; }
+
+private:
+    Iterator first;  ///< první prvek
+    Iterator last;  ///< konec pohledu
+    size_t count;  ///< počet prvků
+};
+
+class CsrGraph;
+
+/**
+ * @brief Pořadí, ve kterém hladový algoritmus barví uzly.
+ *
+ * Všechna pořadí dodrží nejvýše graphDegree + 1 barev, liší se časem výpočtu a počtem použitých barev.
+ */
+enum class ColoringOrder{
+    Natural,  ///< uzly v pořadí rostoucího id, O(V + E)
+    LargestFirst,  ///< uzly sestupně podle stupně, O(V + E)
+    SmallestLast,  ///< degenerační pořadí (opakovaně odebíraný uzel nejmenšího stupně barven poslední), O(V + E)
+    DSatur  ///< vždy uzel s nejvíce různými barvami sousedů, O((V + E) log V), obvykle nejméně barev
+};
+
 /**
  * @brief Třída reprezentující neorientovaný graf bez smyček.
  *
@@ -108,6 +454,26 @@ public:
      */
     std::vector<Edge> edges() const;
 
+    /**
+     * @brief Pohled na všechny uzly grafu bez kopírování, pořadí je stejné jako u nodes().
+     * @return pohled platný do další změny grafu
+     */
+    Range<std::vector<Node*>::const_iterator> nodeRange() const;
+
+    /**
+     * @brief Pohled na všechny hrany grafu bez kopírování, pořadí je stejné jako u edges().
+     * @return pohled platný do další změny grafu
+     */
+    Range<std::vector<Edge>::const_iterator> edgeRange() const;
+
+    /**
+     * @brief Pohled na id sousedů uzlu bez kopírování, v libovolném pořadí.
+     * @param[in] nodeId id uzlu
+     * @return pohled platný do další změny grafu
+     * @exception out_of_range pokud uzel v grafu neexistuje
+     */
+    Range<NeighborSet::const_iterator> neighbors(size_t nodeId) const;
+
     /**
      * Přidá uzel s daným id do grafu a vrátí ukazatel na vytvořený uzel. Pokud uzel existuje vrátí nullptr.
      * Volající se nestárá o mazání uzlu.
@@ -134,6 +500,18 @@ public:
      */
     void addMultipleEdges(const std::vector<Edge>& edges);
 
+    /**
+     * @brief Naplní graf z vektoru hran hromadně. Výsledek je stejný jako při volání addEdge pro každou hranu.
+     *
+     * Hrany jsou normalizovány (menší id první), seřazeny a duplicity odstraněny v jednom průchodu, poté jsou
+     * v původním pořadí vloženy pouze nové hrany bez dalších kontrol duplicit. Řazení může běžet ve více
+     * vláknech.
+     *
+     * @param[in] edges	Vektor obsahující hrany.
+     * @param[in] threads počet vláken pro řazení, 0 znamená počet jader stroje
+     */
+    void addMultipleEdges(const std::vector<Edge>& edges, size_t threads);
+
     /**
      * @brief Vrátí ukazatel na uzel s daným id.
      * @param[in] nodeId	Id uzlu.
@@ -149,7 +527,9 @@ public:
     bool containsEdge(const Edge& edge) const;
 
     /**
-     * odstraní uzel z grafu
+     * odstraní uzel z grafu v čase úměrném stupni uzlu
+     *
+     * Poslední uzel a poslední hrany se přesunou na uvolněná místa, pořadí nodes() a edges() se tedy může změnit.
      *
      * @param[in] nodeId id uzlu, který má být odstraněn
      * @exception out_of_range pokud uzel s daným id v grafu neexistuje
@@ -157,7 +537,9 @@ public:
     void removeNode(size_t nodeId);
 
     /**
-     * odstraní hranu z grafu
+     * odstraní hranu z grafu v konstantním čase
+     *
+     * Poslední hrana se přesune na uvolněné místo, pořadí edges() se tedy může změnit.
      *
      * @param[in] edge hrana, která má být odstraněna
      * @exception out_of_range pokud hrana v grafu neexistuje
@@ -198,15 +580,402 @@ public:
      */
     void coloring();
 
+    /**
+     * Provede obarvení uzlů v grafu hladovým algoritmem se zvoleným pořadím uzlů.
+     * Nepoužije více než graphDegree + 1 barev.
+     *
+     * @param[in] order pořadí barvení uzlů
+     */
+    void coloring(ColoringOrder order);
+
+    /**
+     * Provede obarvení uzlů v grafu, při více vláknech paralelně, viz CsrGraph::coloring(ColoringOrder, size_t).
+     * Nepoužije více než graphDegree + 1 barev.
+     *
+     * @param[in] order pořadí barvení uzlů
+     * @param[in] threads počet vláken, 0 znamená počet jader stroje
+     */
+    void coloring(ColoringOrder order, size_t threads);
+
+    /**
+     * Opraví obarvení po změnách grafu od posledního barvení, nepoužije více než graphDegree + 1 barev.
+     *
+     * Po obarvení si graf zaznamenává uzly dotčené změnami (nové uzly, konce přidaných hran se stejnou barvou,
+     * konce odebraných hran a sousedé odebraných uzlů). Přebarveny jsou jen ty z nich, které mají konflikt se
+     * sousedem nebo barvu vyšší než svůj stupeň + 1, ostatní uzly si barvu ponechají. Pokud graf dosud obarven
+     * nebyl, dotčených uzlů bylo více než uzlů a hran grafu, nebo byl graf načten pomocí load(), provede se
+     * úplné barvení coloring().
+     * Ruční změny atributu color nejsou sledovány.
+     */
+    void updateColoring();
+
     /**
      * Smazání všech uzlů a hran v grafu.
      */
     void clear();
 
+    /**
+     * @brief Vytvoří neměnný snímek grafu v CSR reprezentaci.
+     *
+     * Snímek je na grafu nezávislý, pozdější změny grafu se do něj nepromítnou.
+     *
+     * @return CSR snímek grafu
+     */
+    CsrGraph freeze() const;
+
+    /**
+     * @brief Uloží graf do binárního souboru, viz CsrGraph::save().
+     *
+     * Uloží se uzly, hrany i barvy uzlů, pořadí hran se neuchovává.
+     *
+     * @param[in] path cesta k souboru
+     * @exception runtime_error pokud soubor nelze zapsat
+     */
+    void save(const std::string& path) const;
+
+    /**
+     * @brief Nahradí obsah grafu grafem uloženým v souboru pomocí save().
+     *
+     * Soubor je namapován do paměti a graf je z něj sestaven bez řazení a bez kontrol duplicitních hran.
+     *
+     * @param[in] path cesta k souboru
+     * @exception runtime_error pokud soubor nelze přečíst nebo nemá správný formát
+     */
+    void load(const std::string& path);
+
 protected:
+    friend class CsrGraph;
+
+    static constexpr size_t NO_POSITION = static_cast<size_t>(-1);  ///< uzel záznamu ještě není v gNodes
+
+    /**
+     * @brief Záznam indexu uzlů.
+     *
+     * Spojuje uzel s množinou id jeho sousedů, takže vyhledání uzlu, test existence hrany i stupeň uzlu mají
+     * amortizovaně konstantní složitost. Záznamy přiděluje gEntries a pole množin gBlocks, clear() je proto
+     * uvolní najednou bez procházení záznamů.
+     */
+    struct NodeEntry{
+        Node node{};  ///< uzel, ukazatel na něj je uložen v gNodes
+        size_t position = NO_POSITION;  ///< index uzlu v gNodes
+        NeighborSet neighbors;  ///< id sousedních uzlů a pozice hran k nim v gEdges
+
+        /**
+         * @param[in] pool alokátor polí množiny sousedů
+         */
+        explicit NodeEntry(BlockPool& pool) : neighbors(pool) { }
+    };
+
+    /**
+     * @brief Index id uzlu -> záznam uzlu s otevřenou adresací.
+     *
+     * Drží jen ukazatele na záznamy, adresy záznamů se proto rozšířením indexu nemění. Prázdné pozice mají
+     * nulový ukazatel, odebrané ukazují na DELETED. clear() zachová kapacitu pro další plnění grafu.
+     */
+    class NodeIndex{
+    public:
+
+        /**
+         * @brief Iterátor přes záznamy indexu v libovolném pořadí.
+         */
+        class const_iterator{
+        public:
+            const_iterator(const NodeIndex* index, size_t slot) : index(index), slot(slot) { skipFree(); }
+
+            const NodeEntry* operator*() const { return index->entries[slot]; }
+
+            const_iterator& operator++(){
+                slot++;
+                skipFree();
+                return *this;
+            }
+
+            bool operator!=(const const_iterator& other) const { return slot != other.slot; }
+
+        private:
+            void skipFree(){
+                while (slot < index->capacity && !NodeIndex::occupied(index->entries[slot])){
+                    slot++;
+                }
+            }
+
+            const NodeIndex* index;
+            size_t slot;
+        };
+
+        /**
+         * @param[in] id id uzlu
+         * @return záznam uzlu, nullptr pokud uzel v indexu není
+         */
+        NodeEntry* find(size_t id) const;
+
+        /**
+         * @brief Najde pozici id v indexu, případně ji pro id obsadí.
+         * @param[in] id id uzlu
+         * @return ukazatel na záznam uložený v indexu, nový je nullptr a volající ho nastaví; platí do další změny indexu
+         */
+        NodeEntry*& insert(size_t id);
+
+        /**
+         * @param[in] id id odebíraného uzlu
+         */
+        void erase(size_t id);
+
+        /**
+         * @brief Připraví místo pro daný počet id, aby další vkládání nemuselo realokovat.
+         * @param[in] size požadovaný počet id
+         */
+        void reserve(size_t size);
+
+        /**
+         * @brief Odebere všechna id, kapacita zůstane zachována.
+         */
+        void clear();
+
+        /**
+         * @return true pokud index neobsahuje žádné id
+         */
+        bool empty() const { return used == 0; }
+
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, capacity); }
+
+    private:
+        static NodeEntry* const DELETED;  ///< značka odebrané pozice
+
+        static bool occupied(const NodeEntry* entry) { return entry != nullptr && entry != DELETED; }
+
+        /**
+         * @param[in] id hledané id
+         * @return pozice id, případně první volná pozice jeho sondovací posloupnosti
+         */
+        size_t findSlot(size_t id) const;
+
+        /**
+         * @param[in] newCapacity nová kapacita, mocnina dvou
+         */
+        void rehash(size_t newCapacity);
+
+        std::unique_ptr<size_t[]> keys;  ///< uložená id
+        std::unique_ptr<NodeEntry*[]> entries;  ///< záznamy k uloženým id
+        size_t capacity = 0;  ///< počet pozic, 0 nebo mocnina dvou
+        size_t used = 0;  ///< počet id
+        size_t deleted = 0;  ///< počet odebraných pozic
+    };
+
+    /**
+     * @brief Vrátí záznam uzlu s daným id, případně uzel vytvoří.
+     * @param[in] nodeId Id uzlu.
+     * @return záznam uzlu v indexu
+     */
+    NodeEntry& nodeEntry(size_t nodeId);
+
+    /**
+     * @brief Inicializuje uzel daného záznamu indexu a zařadí ho do gNodes.
+     * @param[in] nodeId Id uzlu.
+     * @param[in, out] entry záznam uzlu v gIndex
+     * @return ukazatel na uzel
+     */
+    Node* createNode(size_t nodeId, NodeEntry& entry);
+
+    /**
+     * @brief Zařadí hranu na konec gEdges a zapíše ji do množin sousedů obou uzlů.
+     * @param[in] edge hrana
+     * @param[in, out] entryA záznam uzlu edge.a
+     * @param[in, out] entryB záznam uzlu edge.b
+     */
+    void appendEdge(const Edge& edge, NodeEntry& entryA, NodeEntry& entryB);
+
+    /**
+     * @brief Odebere hranu na dané pozici z gEdges přesunem poslední hrany na její místo.
+     *
+     * Množiny sousedů odebírané hrany nemění, pouze opraví uloženou pozici přesunuté hrany.
+     *
+     * @param[in] position pozice hrany v gEdges
+     */
+    void eraseEdgeAt(size_t position);
+
+    /**
+     * @brief Zaznamená uzel k opravě barvení v updateColoring(), pokud je obarvení grafu sledováno.
+     * @param[in] nodeId Id uzlu.
+     */
+    void markColorDirty(size_t nodeId);
+
     // doplňte vhodné struktury
     std::vector<Node*> gNodes;
     std::vector<Edge> gEdges;
+    NodeIndex gIndex;  ///< index id uzlu -> záznam uzlu
+    ChunkPool<NodeEntry> gEntries;  ///< alokátor záznamů uzlů
+    BlockPool gBlocks;  ///< alokátor polí množin sousedů
+    std::vector<size_t> gColorDirty;  ///< id uzlů k opravě barvení, mohou se opakovat
+    bool gColoringValid = false;  ///< true pokud barvy uzlů spolu s gColorDirty tvoří platné obarvení
+};
+
+/**
+ * @brief Neměnný snímek grafu v CSR (compressed sparse row) reprezentaci.
+ *
+ * Uzly jsou přečíslovány na souvislé indexy 0 .. nodeCount() - 1 v pořadí rostoucího id. Sousedé uzlu s indexem i
+ * leží v poli neighbors na pozicích offsets[i] .. offsets[i + 1] - 1, takže průchod grafem prochází paměť
+ * sekvenčně. Snímek je určen pro opakované dotazy a barvení nad grafem, který se již nemění.
+ *
+ * Všechna pole leží v jednom souvislém bloku paměti ve stejném tvaru jako v souboru (hlavička o 8 slovech,
+ * ids, offsets, neighbors, colors, vše 64bitová slova v nativním pořadí bajtů). Snímek načtený pomocí load()
+ * proto soubor pouze namapuje do paměti a nic nekopíruje ani nepřepočítává.
+ */
+class CsrGraph{
+public:
+
+    /**
+     * @brief konstruktor prázdného snímku
+     */
+    CsrGraph() = default;
+
+    /**
+     * @brief Vytvoří snímek z daného grafu.
+     * @param[in] graph graf
+     */
+    explicit CsrGraph(const Graph& graph);
+
+    CsrGraph(const CsrGraph&) = delete;
+    CsrGraph& operator=(const CsrGraph&) = delete;
+
+    /**
+     * @brief Přesune snímek, zdrojový snímek zůstane prázdný.
+     * @param[in] other přesouvaný snímek
+     */
+    CsrGraph(CsrGraph&& other) noexcept;
+
+    /**
+     * @brief Přesune snímek, zdrojový snímek zůstane prázdný.
+     * @param[in] other přesouvaný snímek
+     * @return tento snímek
+     */
+    CsrGraph& operator=(CsrGraph&& other) noexcept;
+
+    /**
+     * @brief destruktor snímku, uvolní paměť nebo zruší mapování souboru
+     */
+    ~CsrGraph();
+
+    /**
+     * @brief Uloží snímek včetně barev do binárního souboru.
+     * @param[in] path cesta k souboru
+     * @exception runtime_error pokud soubor nelze zapsat
+     */
+    void save(const std::string& path) const;
+
+    /**
+     * @brief Načte snímek uložený pomocí save().
+     *
+     * Na POSIX systémech je soubor namapován do paměti (mmap, MAP_PRIVATE), dotazy tedy začnou ihned a stránky
+     * se načítají až při prvním přístupu. Barvení načteného snímku soubor nemění. Jinde je soubor přečten celý.
+     *
+     * @param[in] path cesta k souboru
+     * @return načtený snímek
+     * @exception runtime_error pokud soubor nelze přečíst nebo nemá správný formát
+     */
+    static CsrGraph load(const std::string& path);
+
+    /**
+     * @return počet uzlů ve snímku
+     */
+    size_t nodeCount() const;
+
+    /**
+     * @return počet hran ve snímku
+     */
+    size_t edgeCount() const;
+
+    /**
+     * @brief Převede id uzlu na jeho index ve snímku.
+     * @param[in] nodeId id uzlu
+     * @return index uzlu
+     * @exception out_of_range pokud uzel ve snímku neexistuje
+     */
+    size_t nodeIndex(size_t nodeId) const;
+
+    /**
+     * @param[in] index index uzlu
+     * @return id uzlu s daným indexem
+     * @exception out_of_range pokud index leží mimo snímek
+     */
+    size_t nodeId(size_t index) const;
+
+    /**
+     * stupeň uzlu
+     *
+     * @param[in] nodeId id uzlu
+     * @return počet hran, které mají tento uzel za svůj jeden koncový bod
+     * @exception out_of_range pokud uzel ve snímku neexistuje
+     */
+    size_t nodeDegree(size_t nodeId) const;
+
+    /**
+     * @return maximální stupeň uzlu ve snímku
+     */
+    size_t graphDegree() const;
+
+    /**
+     * Provede obarvení uzlů snímku hladovým algoritmem se zvoleným pořadím uzlů,
+     * nepoužije více než graphDegree + 1 barev. Barvy jsou uloženy ve snímku, viz color().
+     *
+     * @param[in] order pořadí barvení uzlů
+     */
+    void coloring(ColoringOrder order = ColoringOrder::Natural);
+
+    /**
+     * Provede obarvení uzlů snímku pomocí více vláken spekulativním hladovým algoritmem.
+     *
+     * Vlákna barví souvislé části zvoleného pořadí současně a vzniklé konflikty mezi sousedy jsou poté
+     * opravovány přebarvením, dokud nějaké zbývají. Výsledné barvení je platné a pro daný počet vláken
+     * nezávisí na plánování vláken, s jiným počtem vláken se však může lišit. Pořadí DSatur je ze své podstaty sekvenční a při jednom vlákně se vždy použije
+     * coloring(ColoringOrder). Nepoužije více než graphDegree + 1 barev.
+     *
+     * @param[in] order pořadí barvení uzlů
+     * @param[in] threads počet vláken, 0 znamená počet jader stroje
+     */
+    void coloring(ColoringOrder order, size_t threads);
+
+    /**
+     * @param[in] nodeId id uzlu
+     * @return barva uzlu převzatá z grafu nebo z posledního barvení snímku, 0 značí neobarveno
+     * @exception out_of_range pokud uzel ve snímku neexistuje
+     */
+    size_t color(size_t nodeId) const;
+
+protected:
+    friend class Graph;
+
+    static constexpr size_t CSR_HEADER_WORDS = 8;  ///< velikost hlavičky souboru ve slovech
+
+    /**
+     * @brief Alokuje vlastní blok paměti pro daný počet uzlů a sousedů a nastaví ukazatele do něj.
+     * @param[in] nodeCount počet uzlů
+     * @param[in] neighborCount délka pole neighbors
+     */
+    void allocate(size_t nodeCount, size_t neighborCount);
+
+    /**
+     * @brief Nastaví ukazatele na pole uvnitř bloku buffer.
+     * @param[in] nodeCount počet uzlů
+     * @param[in] neighborCount délka pole neighbors
+     */
+    void setLayout(size_t nodeCount, size_t neighborCount);
+
+    /**
+     * @brief Uvolní blok paměti nebo zruší mapování a snímek vyprázdní.
+     */
+    void release();
+
+    size_t* buffer = nullptr;  ///< hlavička a všechna pole v jednom bloku
+    size_t bufferBytes = 0;  ///< velikost bloku v bajtech
+    bool mapped = false;  ///< true pokud je blok namapovaný soubor
+    size_t nodes = 0;  ///< počet uzlů
+    size_t neighborCount = 0;  ///< délka pole neighbors, dvojnásobek počtu hran
+    size_t* ids = nullptr;  ///< id uzlů seřazená vzestupně, index do pole je index uzlu
+    size_t* offsets = nullptr;  ///< začátky seznamů sousedů, velikost nodeCount() + 1
+    size_t* neighbors = nullptr;  ///< indexy sousedů všech uzlů za sebou
+    size_t* colors = nullptr;  ///< barvy uzlů podle indexu
 };
 
 #endif // TDD_CODE_H_
@@ -19,6 +19,10 @@
 #include <gmock/gmock.h>
 #include "tdd_code.h"
 
+#include <cstdio>
+#include <fstream>
+#include <random>
+
 using namespace ::testing;
 
 /**
@@ -72,6 +76,28 @@ TEST_F(NonEmptyGraph, edges){
                                             Eq(Edge(5, 7)), Eq(Edge(7, 6))));
 }
 
+TEST_F(NonEmptyGraph, ranges){
+    std::vector<Node*> nodes(graph.nodeRange().begin(), graph.nodeRange().end());
+    EXPECT_EQ(nodes, graph.nodes());
+    EXPECT_EQ(graph.nodeRange().size(), 5);
+
+    std::vector<Edge> edges;
+    for (const Edge& edge : graph.edgeRange()){
+        edges.push_back(edge);
+    }
+    EXPECT_EQ(edges, graph.edges());
+    EXPECT_EQ(graph.edgeRange().size(), 6);
+
+    auto neighbors = graph.neighbors(5);
+    EXPECT_EQ(neighbors.size(), 3);
+    EXPECT_THAT(std::vector<size_t>(neighbors.begin(), neighbors.end()), UnorderedElementsAre(1, 6, 7));
+    EXPECT_THROW(graph.neighbors(9), std::out_of_range);
+
+    graph.removeNode(6);
+    EXPECT_THAT(std::vector<size_t>(graph.neighbors(4).begin(), graph.neighbors(4).end()), ElementsAre(1));
+    EXPECT_EQ(graph.edgeRange().size(), 3);
+}
+
 TEST_F(NonEmptyGraph, addNode){
     auto node = graph.addNode(8);
     ASSERT_NE(node, nullptr);
@@ -177,6 +203,19 @@ TEST_F(NonEmptyGraph, removeNode){
     EXPECT_THROW(graph.removeNode(1), std::out_of_range);
 }
 
+TEST_F(NonEmptyGraph, removeNodeNeighbors){
+    graph.removeNode(5);
+    EXPECT_EQ(graph.nodeDegree(1), 1);
+    EXPECT_EQ(graph.nodeDegree(6), 2);
+    EXPECT_EQ(graph.nodeDegree(7), 1);
+    EXPECT_FALSE(graph.containsEdge(Edge(1, 5)));
+    EXPECT_FALSE(graph.containsEdge(Edge(7, 5)));
+
+    EXPECT_TRUE(graph.addEdge(Edge(5, 1)));
+    EXPECT_EQ(graph.nodeDegree(5), 1);
+    EXPECT_EQ(graph.edgeCount(), 4);
+}
+
 TEST_F(NonEmptyGraph, removeEdge){
     graph.removeEdge(Edge(1, 4));
     auto edges = graph.edges();
@@ -184,6 +223,11 @@ TEST_F(NonEmptyGraph, removeEdge){
                                             Eq(Edge(7, 6))));
 
     EXPECT_THROW(graph.removeEdge(Edge(1, 4)), std::out_of_range);
+
+    graph.removeEdge(Edge(6, 5));
+    EXPECT_FALSE(graph.containsEdge(Edge(5, 6)));
+    EXPECT_EQ(graph.nodeDegree(5), 2);
+    EXPECT_EQ(graph.nodeDegree(6), 2);
 }
 
 TEST_F(NonEmptyGraph, nodeCount){
@@ -225,6 +269,161 @@ TEST_F(NonEmptyGraph, coloring){
     }
 }
 
+TEST_F(NonEmptyGraph, coloringOrders){
+    graph.addMultipleEdges({{1, 6}, {4, 7}, {8, 9}});
+    size_t maxColor = graph.graphDegree() + 1;
+
+    for (auto order : {ColoringOrder::Natural, ColoringOrder::LargestFirst, ColoringOrder::SmallestLast,
+                       ColoringOrder::DSatur}){
+        graph.coloring(order);
+        for (auto node : graph.nodes()){
+            EXPECT_GE(node->color, 1);
+            EXPECT_LE(node->color, maxColor);
+        }
+        for (auto edge : graph.edges()){
+            EXPECT_NE(graph.getNode(edge.a)->color, graph.getNode(edge.b)->color);
+        }
+    }
+}
+
+TEST_F(NonEmptyGraph, coloringParallel){
+    for (size_t id = 10; id < 200; id++){
+        graph.addEdge(Edge(id, id / 3));
+        graph.addEdge(Edge(id, id * 7 % 191));
+    }
+    size_t maxColor = graph.graphDegree() + 1;
+
+    for (size_t threads : {2, 4}){
+        graph.coloring(ColoringOrder::Natural, threads);
+        for (auto node : graph.nodes()){
+            EXPECT_GE(node->color, 1);
+            EXPECT_LE(node->color, maxColor);
+        }
+        for (auto edge : graph.edges()){
+            EXPECT_NE(graph.getNode(edge.a)->color, graph.getNode(edge.b)->color);
+        }
+    }
+
+    CsrGraph snapshot = graph.freeze();
+    snapshot.coloring(ColoringOrder::SmallestLast, 3);
+    for (auto edge : graph.edges()){
+        EXPECT_NE(snapshot.color(edge.a), snapshot.color(edge.b));
+    }
+}
+
+// Dense graph splits across thread chunks, so repair rounds recolor nodes; result must not depend on scheduling
+TEST_F(EmptyGraph, coloringParallelConflicts){
+    for (size_t a = 0; a < 120; a++){
+        for (size_t b = a + 1; b < 120; b++){
+            if ((a * 31 + b * 17) % 5 != 0){
+                graph.addEdge(Edge(a, b));
+            }
+        }
+    }
+
+    std::vector<size_t> first;
+    for (size_t repeat = 0; repeat < 5; repeat++){
+        graph.coloring(ColoringOrder::Natural, 16);
+        std::vector<size_t> colors;
+        for (auto node : graph.nodes()){
+            ASSERT_GE(node->color, 1);
+            ASSERT_LE(node->color, graph.nodeDegree(node->id) + 1);
+            colors.push_back(node->color);
+        }
+        for (auto edge : graph.edges()){
+            ASSERT_NE(graph.getNode(edge.a)->color, graph.getNode(edge.b)->color);
+        }
+        if (repeat == 0){
+            first = colors;
+        }
+        EXPECT_EQ(colors, first);
+    }
+}
+
+// Sparse graphs keep recoloring low-degree nodes over several rounds, each must stay within its degree + 1
+TEST(GraphColoring, parallelDegreeBound){
+    std::mt19937 generator(7);
+    std::bernoulli_distribution hasEdge(0.02);
+    for (size_t round = 0; round < 30; round++){
+        Graph sparse;
+        for (size_t a = 1; a <= 100; a++){
+            for (size_t b = a + 1; b <= 100; b++){
+                if (hasEdge(generator)){
+                    sparse.addEdge(Edge(a, b));
+                }
+            }
+        }
+        for (size_t threads : {2, 3, 4, 8, 16}){
+            sparse.coloring(ColoringOrder::Natural, threads);
+            for (auto node : sparse.nodes()){
+                ASSERT_GE(node->color, 1);
+                ASSERT_LE(node->color, sparse.nodeDegree(node->id) + 1);
+            }
+            for (auto edge : sparse.edges()){
+                ASSERT_NE(sparse.getNode(edge.a)->color, sparse.getNode(edge.b)->color);
+            }
+        }
+    }
+}
+
+TEST_F(NonEmptyGraph, updateColoring){
+    for (size_t id = 10; id < 200; id++){
+        graph.addEdge(Edge(id, id / 3));
+        graph.addEdge(Edge(id, id * 7 % 191));
+    }
+    graph.coloring();
+    size_t color150 = graph.getNode(150)->color;
+
+    // Edges between equally colored nodes, a new node and removals lowering degrees
+    size_t added = 0;
+    for (size_t id = 10; id < 200 && added < 20; id++){
+        for (size_t other = id + 1; other < 200; other++){
+            if (id != 150 && other != 150 && graph.getNode(id)->color == graph.getNode(other)->color &&
+                graph.addEdge(Edge(id, other))){
+                added++;
+                break;
+            }
+        }
+    }
+    graph.addEdge(Edge(300, 5));
+    graph.removeNode(6);
+    graph.removeEdge(Edge(1, 4));
+    graph.updateColoring();
+
+    EXPECT_EQ(graph.getNode(150)->color, color150);
+    for (auto node : graph.nodes()){
+        EXPECT_GE(node->color, 1);
+        EXPECT_LE(node->color, graph.nodeDegree(node->id) + 1);
+    }
+    for (auto edge : graph.edges()){
+        EXPECT_NE(graph.getNode(edge.a)->color, graph.getNode(edge.b)->color);
+    }
+}
+
+TEST_F(NonEmptyGraph, updateColoringDegree){
+    // Clique 10 .. 19 attached to node 5, node 19 keeps a high color after losing its clique edges
+    for (size_t id = 10; id < 20; id++){
+        graph.addEdge(Edge(id, 5));
+        for (size_t other = 10; other < id; other++){
+            graph.addEdge(Edge(id, other));
+        }
+    }
+    graph.coloring();
+    ASSERT_GT(graph.getNode(19)->color, 2);
+    for (size_t other = 10; other < 19; other++){
+        graph.removeEdge(Edge(19, other));
+    }
+    graph.updateColoring();
+
+    EXPECT_LE(graph.getNode(19)->color, 2);
+    for (auto node : graph.nodes()){
+        EXPECT_LE(node->color, graph.graphDegree() + 1);
+    }
+    for (auto edge : graph.edges()){
+        EXPECT_NE(graph.getNode(edge.a)->color, graph.getNode(edge.b)->color);
+    }
+}
+
 TEST_F(NonEmptyGraph, clear){
     graph.clear();
     auto nodes = graph.nodes();
@@ -234,6 +433,158 @@ TEST_F(NonEmptyGraph, clear){
     EXPECT_EQ(edges.size(), 0);
 }
 
+TEST_F(NonEmptyGraph, freeze){
+    CsrGraph snapshot = graph.freeze();
+    graph.removeNode(5);
+
+    EXPECT_EQ(snapshot.nodeCount(), 5);
+    EXPECT_EQ(snapshot.edgeCount(), 6);
+    EXPECT_EQ(snapshot.nodeDegree(1), 2);
+    EXPECT_EQ(snapshot.nodeDegree(5), 3);
+    EXPECT_EQ(snapshot.nodeDegree(7), 2);
+    EXPECT_EQ(snapshot.graphDegree(), 3);
+    EXPECT_EQ(snapshot.nodeId(snapshot.nodeIndex(6)), 6);
+    EXPECT_THROW(snapshot.nodeDegree(9), std::out_of_range);
+}
+
+TEST_F(NonEmptyGraph, freezeColoring){
+    CsrGraph snapshot = graph.freeze();
+    EXPECT_EQ(snapshot.color(1), 0);
+
+    snapshot.coloring();
+    std::set<size_t> colors;
+    for (size_t i = 0; i < snapshot.nodeCount(); i++){
+        colors.insert(snapshot.color(snapshot.nodeId(i)));
+    }
+    EXPECT_TRUE(*colors.begin() != 0);
+    EXPECT_LE(colors.size(), 4);
+
+    for (auto edge : graph.edges()){
+        EXPECT_NE(snapshot.color(edge.a), snapshot.color(edge.b));
+    }
+}
+
+TEST_F(NonEmptyGraph, saveLoad){
+    std::string path = TempDir() + "tdd_graph.csr";
+    graph.coloring();
+    graph.save(path);
+
+    CsrGraph snapshot = CsrGraph::load(path);
+    EXPECT_EQ(snapshot.nodeCount(), 5);
+    EXPECT_EQ(snapshot.edgeCount(), 6);
+    EXPECT_EQ(snapshot.nodeDegree(5), 3);
+    EXPECT_EQ(snapshot.color(4), graph.getNode(4)->color);
+
+    // Coloring the mapped snapshot must not change the file
+    snapshot.coloring(ColoringOrder::DSatur);
+    Graph loaded;
+    loaded.addEdge(Edge(8, 9));
+    loaded.load(path);
+    EXPECT_THAT(loaded.edges(), UnorderedElementsAreArray(graph.edges()));
+    for (auto node : graph.nodes()){
+        ASSERT_NE(loaded.getNode(node->id), nullptr);
+        EXPECT_EQ(loaded.getNode(node->id)->color, node->color);
+        EXPECT_EQ(loaded.nodeDegree(node->id), graph.nodeDegree(node->id));
+    }
+    EXPECT_EQ(loaded.getNode(8), nullptr);
+    EXPECT_TRUE(loaded.containsEdge(Edge(6, 7)));
+    std::remove(path.c_str());
+}
+
+// Saving a mapped snapshot over its own file must not truncate the pages it reads from
+TEST_F(NonEmptyGraph, saveOverLoadedFile){
+    std::string path = TempDir() + "tdd_resave.csr";
+    graph.save(path);
+    CsrGraph snapshot = CsrGraph::load(path);
+    snapshot.coloring(ColoringOrder::DSatur);
+    snapshot.save(path);
+
+    EXPECT_EQ(snapshot.nodeCount(), 5);
+    EXPECT_EQ(snapshot.nodeDegree(5), 3);
+    CsrGraph reloaded = CsrGraph::load(path);
+    EXPECT_EQ(reloaded.edgeCount(), 6);
+    for (auto node : graph.nodes()){
+        EXPECT_EQ(reloaded.color(node->id), snapshot.color(node->id));
+    }
+    std::ifstream temporary(path + ".tmp");
+    EXPECT_FALSE(temporary.good());
+    std::remove(path.c_str());
+}
+
+TEST_F(EmptyGraph, saveLoad){
+    std::string path = TempDir() + "tdd_empty.csr";
+    graph.save(path);
+    graph.addEdge(Edge(1, 2));
+    graph.load(path);
+    EXPECT_EQ(graph.nodeCount(), 0);
+    EXPECT_EQ(graph.edgeCount(), 0);
+
+    std::ofstream(path) << "not a graph";
+    EXPECT_THROW(graph.load(path), std::runtime_error);
+    std::remove(path.c_str());
+    EXPECT_THROW(CsrGraph::load(path), std::runtime_error);
+}
+
+// Corrupted counts, offsets, neighbors or ids are rejected instead of trusted by later lookups
+TEST_F(NonEmptyGraph, loadCorrupted){
+    std::string path = TempDir() + "tdd_corrupted.csr";
+    graph.save(path);
+    // 8 header words, then ids, offsets, neighbors and colors of 5 nodes with 6 edges
+    std::vector<size_t> words(8 + 3 * 5 + 1 + 12);
+    std::ifstream(path, std::ios::binary).read(reinterpret_cast<char*>(words.data()), words.size() * sizeof(size_t));
+    size_t ids = 8;
+    size_t offsets = ids + 5;
+    size_t neighbors = offsets + 6;
+
+    auto expectInvalid = [&](size_t word, size_t value){
+        std::vector<size_t> corrupted = words;
+        corrupted[word] = value;
+        std::ofstream(path, std::ios::binary | std::ios::trunc)
+            .write(reinterpret_cast<const char*>(corrupted.data()), corrupted.size() * sizeof(size_t));
+        EXPECT_THROW(CsrGraph::load(path), std::runtime_error) << "word " << word;
+    };
+    // Node count whose size formula wraps around to the real file size
+    expectInvalid(1, 5 + (size_t(1) << 61));
+    expectInvalid(offsets, 1);
+    expectInvalid(offsets + 2, words[offsets + 3] + 1);
+    expectInvalid(offsets + 5, 11);
+    expectInvalid(neighbors + 3, 5);
+    expectInvalid(ids + 1, words[ids]);
+
+    std::ofstream(path, std::ios::binary | std::ios::trunc)
+        .write(reinterpret_cast<const char*>(words.data()), words.size() * sizeof(size_t));
+    EXPECT_EQ(CsrGraph::load(path).edgeCount(), 6);
+
+    // Two nodes with ids 1 and 2, header taken from the saved file
+    auto writeLists = [&](const std::vector<size_t>& offsetList, const std::vector<size_t>& neighborList){
+        std::vector<size_t> file(words.begin(), words.begin() + 8);
+        file[1] = 2;
+        file[2] = neighborList.size();
+        file.insert(file.end(), {1, 2});
+        file.insert(file.end(), offsetList.begin(), offsetList.end());
+        file.insert(file.end(), neighborList.begin(), neighborList.end());
+        file.insert(file.end(), {0, 0});
+        std::ofstream(path, std::ios::binary | std::ios::trunc)
+            .write(reinterpret_cast<const char*>(file.data()), file.size() * sizeof(size_t));
+    };
+    // Duplicate entries would load as two copies of one edge
+    writeLists({0, 2, 4}, {1, 1, 0, 0});
+    EXPECT_THROW(CsrGraph::load(path), std::runtime_error);
+    // Self-loop
+    writeLists({0, 2, 3}, {0, 1, 0});
+    EXPECT_THROW(CsrGraph::load(path), std::runtime_error);
+    // Edge stored only for one endpoint
+    writeLists({0, 0, 1}, {0});
+    EXPECT_THROW(CsrGraph::load(path), std::runtime_error);
+
+    writeLists({0, 1, 2}, {1, 0});
+    Graph loaded;
+    loaded.load(path);
+    EXPECT_EQ(loaded.edgeCount(), 1);
+    EXPECT_TRUE(loaded.containsEdge(Edge(1, 2)));
+    std::remove(path.c_str());
+}
+
 TEST_F(EmptyGraph, nodes){
     auto nodes = graph.nodes();
     EXPECT_EQ(nodes.size(), 0);
@@ -244,6 +595,13 @@ TEST_F(EmptyGraph, edges){
     EXPECT_EQ(edges.size(), 0);
 }
 
+TEST_F(EmptyGraph, ranges){
+    EXPECT_TRUE(graph.nodeRange().empty());
+    EXPECT_TRUE(graph.edgeRange().empty());
+    EXPECT_EQ(graph.edgeRange().begin(), graph.edgeRange().end());
+    EXPECT_THROW(graph.neighbors(1), std::out_of_range);
+}
+
 TEST_F(EmptyGraph, addNode){
     auto node = graph.addNode(1);
     ASSERT_NE(node, nullptr);
@@ -322,6 +680,12 @@ TEST_F(EmptyGraph, coloring){
     EXPECT_EQ(nodes.size(), 0);
 }
 
+TEST_F(EmptyGraph, coloringOrders){
+    graph.coloring(ColoringOrder::DSatur);
+    graph.freeze().coloring(ColoringOrder::SmallestLast);
+    EXPECT_EQ(graph.nodes().size(), 0);
+}
+
 TEST_F(EmptyGraph, clear){
     graph.clear();
     auto nodes = graph.nodes();
@@ -331,6 +695,178 @@ TEST_F(EmptyGraph, clear){
     EXPECT_EQ(edges.size(), 0);
 }
 
+TEST_F(EmptyGraph, updateColoring){
+    // Without previous coloring the whole graph is colored
+    graph.addMultipleEdges({{1, 2}, {2, 3}, {3, 1}});
+    graph.updateColoring();
+    EXPECT_NE(graph.getNode(1)->color, 0);
+    EXPECT_NE(graph.getNode(1)->color, graph.getNode(2)->color);
+    EXPECT_NE(graph.getNode(1)->color, graph.getNode(3)->color);
+    EXPECT_NE(graph.getNode(2)->color, graph.getNode(3)->color);
+}
+
+TEST_F(EmptyGraph, churn){
+    // Random mix of edge additions and node/edge removals checked against a plain edge set
+    std::set<std::pair<size_t, size_t>> expected;
+    size_t state = 12345;
+    auto next = [&state](size_t bound){
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (state >> 33) % bound;
+    };
+
+    for (size_t step = 0; step < 5000; step++){
+        size_t a = next(40), b = next(40);
+        size_t action = next(10);
+        if (action < 6){
+            bool added = a != b && expected.emplace(std::min(a, b), std::max(a, b)).second;
+            EXPECT_EQ(graph.addEdge(Edge(a, b)), added);
+        }
+        else if (action < 9 && !expected.empty()){
+            auto edge = *std::next(expected.begin(), next(expected.size()));
+            graph.removeEdge(Edge(edge.second, edge.first));
+            expected.erase(edge);
+        }
+        else if (graph.getNode(a) != nullptr){
+            graph.removeNode(a);
+            for (auto it = expected.begin(); it != expected.end();){
+                it = it->first == a || it->second == a ? expected.erase(it) : std::next(it);
+            }
+            EXPECT_EQ(graph.getNode(a), nullptr);
+        }
+    }
+
+    std::set<std::pair<size_t, size_t>> edges;
+    for (const Edge& edge : graph.edgeRange()){
+        edges.emplace(std::min(edge.a, edge.b), std::max(edge.a, edge.b));
+        EXPECT_TRUE(graph.containsEdge(edge));
+    }
+    EXPECT_EQ(edges, expected);
+    EXPECT_EQ(graph.edgeCount(), expected.size());
+    for (const Node* node : graph.nodeRange()){
+        EXPECT_EQ(graph.getNode(node->id), node);
+    }
+    EXPECT_THROW(graph.removeEdge(Edge(100, 101)), std::out_of_range);
+}
+
+
+TEST_F(NonEmptyGraph, addMultipleEdgesBulk){
+    std::vector<Edge> edges;
+    for (size_t i = 0; i < 3000; i++){
+        edges.emplace_back(i % 97, i * 31 % 89);
+        edges.emplace_back(i * 7 % 89, i % 97);
+    }
+    edges.emplace_back(1, 4);
+    edges.emplace_back(3, 3);
+
+    Graph sequential;
+    sequential.addMultipleEdges({{ 1, 4 }, { 1, 5 }, { 4, 6 }, { 5, 6 }, { 5, 7 }, { 7, 6 } });
+    for (const auto& edge : edges){
+        sequential.addEdge(edge);
+    }
+    graph.addMultipleEdges(edges, 4);
+
+    EXPECT_EQ(graph.edges(), sequential.edges());
+    std::vector<size_t> ids, sequentialIds;
+    for (auto node : graph.nodes()){
+        ids.push_back(node->id);
+    }
+    for (auto node : sequential.nodes()){
+        sequentialIds.push_back(node->id);
+    }
+    EXPECT_EQ(ids, sequentialIds);
+    EXPECT_EQ(graph.graphDegree(), sequential.graphDegree());
+}
+
+TEST(NeighborSet, insertErase){
+    BlockPool pool;
+    NeighborSet set(pool);
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(set.count(5), 0);
+    EXPECT_FALSE(set.erase(5));
+
+    for (size_t id = 0; id < 1000; id++){
+        EXPECT_TRUE(set.insert(id * 3, id));
+    }
+    EXPECT_FALSE(set.insert(0, 7));
+    EXPECT_EQ(set.size(), 1000);
+    ASSERT_NE(set.findPosition(0), nullptr);
+    EXPECT_EQ(*set.findPosition(0), 0);
+    EXPECT_EQ(*set.findPosition(2997), 999);
+    EXPECT_EQ(set.findPosition(1), nullptr);
+
+    for (size_t id = 0; id < 1000; id += 2){
+        EXPECT_TRUE(set.erase(id * 3));
+    }
+    EXPECT_EQ(set.size(), 500);
+    EXPECT_EQ(set.count(3), 1);
+    EXPECT_EQ(set.count(6), 0);
+    EXPECT_EQ(set.count(SIZE_MAX), 0);
+    EXPECT_EQ(*set.findPosition(3), 1);
+
+    std::set<size_t> items(set.begin(), set.end());
+    EXPECT_EQ(items.size(), 500);
+    EXPECT_EQ(*items.begin(), 3);
+
+    // Repeated insert/erase doesn't fill the table with deleted slots
+    for (size_t round = 0; round < 100000; round++){
+        EXPECT_TRUE(set.insert(SIZE_MAX - round, round));
+        EXPECT_TRUE(set.erase(SIZE_MAX - round));
+    }
+    EXPECT_EQ(set.size(), 500);
+}
+
+TEST(NodePool, allocate){
+    NodePool pool;
+    std::vector<Node*> nodes;
+    for (size_t i = 0; i < 1000; i++){
+        nodes.push_back(pool.allocate());
+        nodes.back()->id = i;
+    }
+    EXPECT_GT(pool.chunkCount(), 1);
+
+    for (size_t i = 0; i < nodes.size(); i++){
+        EXPECT_EQ(nodes[i]->id, i);
+    }
+    EXPECT_EQ(std::set<Node*>(nodes.begin(), nodes.end()).size(), nodes.size());
+
+    pool.deallocate(nodes[10]);
+    EXPECT_EQ(pool.allocate(), nodes[10]);
+
+    pool.release();
+    EXPECT_EQ(pool.chunkCount(), 0);
+}
+
+TEST(BlockPool, allocate){
+    BlockPool pool;
+    std::vector<size_t*> blocks;
+    for (size_t i = 0; i < 1000; i++){
+        blocks.push_back(static_cast<size_t*>(pool.allocate(8 * (i % 40 + 1))));
+        blocks.back()[i % 40] = i;
+    }
+    for (size_t i = 0; i < blocks.size(); i++){
+        EXPECT_EQ(blocks[i][i % 40], i);
+    }
+    EXPECT_GT(pool.chunkCount(), 1);
+
+    // Returned blocks are reused by requests of the same size class, oversized ones too
+    pool.deallocate(blocks[10], 88);
+    EXPECT_EQ(pool.allocate(100), blocks[10]);
+    void* large = pool.allocate(1 << 22);
+    pool.deallocate(large, 1 << 22);
+    EXPECT_EQ(pool.allocate(1 << 22), large);
+
+    pool.release();
+    EXPECT_EQ(pool.chunkCount(), 0);
+}
+
+TEST_F(NonEmptyGraph, stableNodeAddresses){
+    Node* node = graph.getNode(5);
+    for (size_t id = 100; id < 5000; id++){
+        graph.addNode(id);
+    }
+    EXPECT_EQ(graph.getNode(5), node);
+    EXPECT_EQ(node->id, 5);
+}
 
 TEST(Edges, equal){
     EXPECT_TRUE(Edge(1, 4)==Edge(1, 4));
@@ -0,0 +1,1109 @@
+//======= Copyright (c) 2025, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     White Box - hash map benchmarks
+//
+// $NoKeywords: $ivs_project_1 $white_box_benchmark.cpp
+// $Author:     Jakub Lůčný <xlucnyj00@stud.fit.vutbr.cz>
+// $Date:       $2025-03-24
+//============================================================================//
+/**
+ * @file white_box_benchmark.cpp
+ * @author Jakub Lůčný
+ *
+ * @brief Měření výkonu hašovací tabulky.
+ *
+ * Použití: white_box_benchmark [název měření|all] [maximální počet klíčů]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "white_box_code.h"
+
+// Number of malloc calls, counted by interposing glibc malloc
+static size_t mallocCount = 0;
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#define WHITE_BOX_COUNT_MALLOC
+extern "C" void* __libc_malloc(size_t size);
+
+extern "C" void* malloc(size_t size){
+    mallocCount++;
+    return __libc_malloc(size);
+}
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Milliseconds elapsed since given time point
+double elapsedMs(Clock::time_point start){
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Realistic key sets, every generator returns count distinct keys
+std::vector<std::string> sequentialIds(size_t count){
+    std::vector<std::string> keys;
+    char buffer[32];
+    for (size_t i = 0; i < count; i++){
+        std::snprintf(buffer, sizeof(buffer), "user_%08zu", i);
+        keys.emplace_back(buffer);
+    }
+    return keys;
+}
+
+std::vector<std::string> hexIds(size_t count){
+    std::mt19937_64 rng(42);
+    std::vector<std::string> keys;
+    char buffer[40];
+    for (size_t i = 0; i < count; i++){
+        // the counter in the low half keeps the keys distinct
+        std::snprintf(buffer, sizeof(buffer), "%016llx%016llx", (unsigned long long)rng(), (unsigned long long)i);
+        keys.emplace_back(buffer);
+    }
+    return keys;
+}
+
+std::vector<std::string> urlPaths(size_t count){
+    std::vector<std::string> keys;
+    char buffer[96];
+    for (size_t i = 0; i < count; i++){
+        std::snprintf(buffer, sizeof(buffer), "/api/v2/customers/%zu/orders/%zu/items", i / 16, i % 16);
+        keys.emplace_back(buffer);
+    }
+    return keys;
+}
+
+struct KeySet{
+    const char* name;
+    std::vector<std::string> (*generate)(size_t count);
+};
+
+const KeySet keySets[] = {
+    {"ids", sequentialIds},
+    {"hex", hexIds},
+    {"urls", urlPaths},
+};
+
+struct HashFunction{
+    const char* name;
+    hash_map_hash_function_t function;
+};
+
+const HashFunction hashFunctions[] = {
+    {"additive", hash_map_hash_additive},
+    {"wy", hash_map_hash_wy},
+};
+
+// Average number of index slots visited by successful lookups
+double averageProbeLength(hash_map_t* map){
+    hash_map_stats_t stats;
+    hash_map_stats(map, &stats, true);
+    return stats.probe_average;
+}
+
+// Probe length and put/get throughput of both hash functions on every key set
+void benchHash(size_t maxKeys){
+    std::cout << std::setw(8) << "keys" << std::setw(10) << "key set" << std::setw(10) << "hash"
+              << std::setw(10) << "probes" << std::setw(16) << "put [Mops/s]" << std::setw(16) << "get [Mops/s]"
+              << std::setw(16) << "miss [Mops/s]" << '\n';
+
+    for (const KeySet& keySet : keySets){
+        // Hash function that became too slow is not measured on larger sets
+        std::vector<bool> tooSlow(sizeof(hashFunctions) / sizeof(hashFunctions[0]), false);
+        for (size_t keyCount = 1000; keyCount <= maxKeys; keyCount *= 10){
+            std::vector<std::string> keys = keySet.generate(keyCount);
+            std::vector<std::string> missing = keySet.generate(2 * keyCount);
+            missing.erase(missing.begin(), missing.begin() + keyCount);
+
+            for (size_t h = 0; h < tooSlow.size(); h++){
+                std::cout << std::setw(8) << keyCount << std::setw(10) << keySet.name << std::setw(10)
+                          << hashFunctions[h].name;
+                if (tooSlow[h]){
+                    std::cout << "   skipped\n";
+                    continue;
+                }
+
+                hash_map_config_t config = {};
+                config.hash_function = hashFunctions[h].function;
+                hash_map_t* map = hash_map_ctor_with_config(&config);
+
+                auto start = Clock::now();
+                for (size_t i = 0; i < keys.size(); i++){
+                    hash_map_put(map, keys[i].c_str(), (int)i);
+                }
+                double putMs = elapsedMs(start);
+
+                long long sum = 0;
+                int value = 0;
+                start = Clock::now();
+                for (const std::string& key : keys){
+                    hash_map_get(map, key.c_str(), &value);
+                    sum += value;
+                }
+                double getMs = elapsedMs(start);
+
+                size_t found = 0;
+                start = Clock::now();
+                for (const std::string& key : missing){
+                    found += hash_map_contains(map, key.c_str());
+                }
+                double missMs = elapsedMs(start);
+
+                std::cout << std::fixed << std::setprecision(2) << std::setw(10) << averageProbeLength(map)
+                          << std::setw(16) << keyCount / putMs / 1000 << std::setw(16) << keyCount / getMs / 1000
+                          << std::setw(16) << keyCount / missMs / 1000
+                          << (hash_map_size(map) == keyCount && found == 0 ? "" : "  MISMATCH") << '\n';
+                // Quadratic behaviour would take 100 times longer on the next set
+                tooSlow[h] = putMs + getMs + missMs > 250;
+                hash_map_dtor(map);
+                (void)sum;
+            }
+        }
+    }
+}
+
+// Insert and remove throughput with malloc calls per inserted key, short keys of 9-16 bytes
+void benchKeys(size_t maxKeys){
+    std::cout << std::setw(10) << "keys" << std::setw(16) << "put [Mops/s]" << std::setw(16) << "mallocs / key"
+              << std::setw(18) << "remove [Mops/s]" << '\n';
+
+    for (size_t keyCount = 100000; keyCount <= maxKeys; keyCount *= 10){
+        std::vector<std::string> keys = sequentialIds(keyCount);
+        hash_map_t* map = hash_map_ctor();
+
+        size_t mallocsBefore = mallocCount;
+        auto start = Clock::now();
+        for (size_t i = 0; i < keys.size(); i++){
+            hash_map_put(map, keys[i].c_str(), (int)i);
+        }
+        double putMs = elapsedMs(start);
+        size_t mallocs = mallocCount - mallocsBefore;
+
+        start = Clock::now();
+        for (const std::string& key : keys){
+            hash_map_remove(map, key.c_str());
+        }
+        double removeMs = elapsedMs(start);
+
+        std::cout << std::setw(10) << keyCount << std::fixed << std::setprecision(2) << std::setw(16)
+                  << keyCount / putMs / 1000;
+#ifdef WHITE_BOX_COUNT_MALLOC
+        std::cout << std::setw(16) << (double)mallocs / keyCount;
+#else
+        std::cout << std::setw(16) << "n/a";
+        (void)mallocs;
+#endif
+        std::cout << std::setw(18) << keyCount / removeMs / 1000
+                  << (map->first == NULL ? "" : "  MISMATCH") << '\n';
+        hash_map_dtor(map);
+    }
+}
+
+// Repeated fill and clear cycles of one map, items allocated one by one versus from an arena
+void benchArena(size_t maxKeys){
+    std::cout << std::setw(10) << "keys" << std::setw(8) << "cycles" << std::setw(8) << "arena"
+              << std::setw(16) << "fill [ms]" << std::setw(14) << "clear [ms]" << std::setw(18) << "mallocs / cycle"
+              << '\n';
+
+    for (size_t keyCount : {1000, 100000, 10000000}){
+        if (keyCount > maxKeys){
+            break;
+        }
+        std::vector<std::string> keys = sequentialIds(keyCount);
+        size_t cycles = std::max<size_t>(2, 1000000 / keyCount);
+
+        for (bool arena : {false, true}){
+            hash_map_config_t config = {};
+            config.arena = arena;
+            hash_map_t* map = hash_map_ctor_with_config(&config);
+
+            // The first cycle grows the index and the arena, only the following ones are measured
+            double fillMs = 0, clearMs = 0;
+            size_t mallocs = 0;
+            for (size_t cycle = 0; cycle <= cycles; cycle++){
+                size_t mallocsBefore = mallocCount;
+                auto start = Clock::now();
+                for (size_t i = 0; i < keys.size(); i++){
+                    hash_map_put(map, keys[i].c_str(), (int)i);
+                }
+                double cycleFillMs = elapsedMs(start);
+
+                start = Clock::now();
+                hash_map_clear(map);
+                if (cycle > 0){
+                    fillMs += cycleFillMs;
+                    clearMs += elapsedMs(start);
+                    mallocs += mallocCount - mallocsBefore;
+                }
+            }
+            hash_map_dtor(map);
+
+            std::cout << std::setw(10) << keyCount << std::setw(8) << cycles << std::setw(8) << (arena ? "yes" : "no")
+                      << std::fixed << std::setprecision(3) << std::setw(16) << fillMs / cycles << std::setw(14)
+                      << clearMs / cycles;
+#ifdef WHITE_BOX_COUNT_MALLOC
+            std::cout << std::setw(18) << mallocs / cycles << '\n';
+#else
+            std::cout << std::setw(18) << "n/a" << '\n';
+            (void)mallocs;
+#endif
+        }
+    }
+}
+
+// Lookup latency in random order at growing load factor of a fixed index sized for maxKeys keys
+void benchLoad(size_t maxKeys){
+    size_t capacity = HASH_MAP_INIT_SIZE;
+    while (capacity * 3 < maxKeys * 5){
+        capacity *= 2;
+    }
+    std::cout << "index size " << capacity << '\n' << std::setw(10) << "keys" << std::setw(8) << "load"
+              << std::setw(10) << "probes" << std::setw(14) << "hit [ns]" << std::setw(14) << "miss [ns]" << '\n';
+
+    // The highest measured load stays just below the resize threshold
+    maxKeys = (size_t)(0.59 * capacity);
+    std::vector<std::string> all = sequentialIds(2 * maxKeys);
+    std::vector<std::string> keys(all.begin(), all.begin() + maxKeys);
+    std::vector<std::string> missing(all.begin() + maxKeys, all.end());
+    std::vector<std::string>().swap(all);
+    std::mt19937_64 rng(42);
+    std::shuffle(missing.begin(), missing.end(), rng);
+
+    for (double load : {0.3, 0.45, 0.59}){
+        size_t keyCount = (size_t)(load * capacity);
+        hash_map_t* map = hash_map_ctor();
+        hash_map_reserve(map, capacity);
+        for (size_t i = 0; i < keyCount; i++){
+            hash_map_put(map, keys[i].c_str(), (int)i);
+        }
+
+        std::vector<const char*> order(keyCount);
+        for (size_t i = 0; i < keyCount; i++){
+            order[i] = keys[i].c_str();
+        }
+        std::shuffle(order.begin(), order.end(), rng);
+
+        long long sum = 0;
+        int value = 0;
+        auto start = Clock::now();
+        for (const char* key : order){
+            hash_map_get(map, key, &value);
+            sum += value;
+        }
+        double hitNs = elapsedMs(start) * 1e6 / keyCount;
+
+        size_t found = 0;
+        start = Clock::now();
+        for (size_t i = 0; i < keyCount; i++){
+            found += hash_map_contains(map, missing[i].c_str());
+        }
+        double missNs = elapsedMs(start) * 1e6 / keyCount;
+
+        std::cout << std::setw(10) << keyCount << std::fixed << std::setprecision(2) << std::setw(8)
+                  << (double)keyCount / hash_map_capacity(map) << std::setw(10) << averageProbeLength(map)
+                  << std::setw(14) << hitNs << std::setw(14) << missNs
+                  << (hash_map_capacity(map) == capacity && found == 0 ? "" : "  MISMATCH") << '\n';
+        hash_map_dtor(map);
+        (void)sum;
+    }
+}
+
+struct Engine{
+    const char* name;
+    hash_map_engine_t engine;
+};
+
+const Engine engines[] = {
+    {"perturb", HASH_MAP_ENGINE_PERTURB},
+    {"group", HASH_MAP_ENGINE_GROUP},
+};
+
+// Share of get and put operations in percent, the rest are pops
+struct Mix{
+    const char* name;
+    unsigned getPercent;
+    unsigned putPercent;
+};
+
+const Mix mixes[] = {
+    {"get", 100, 0},
+    {"90/5/5", 90, 5},
+    {"50/25/25", 50, 25},
+    {"10/45/45", 10, 45},
+};
+
+// Throughput of both index engines, building from empty and random get/put/pop mixes on a half full key set
+void benchEngines(size_t maxKeys){
+    std::cout << std::setw(10) << "keys" << std::setw(10) << "engine" << std::setw(10) << "mix"
+              << std::setw(14) << "[Mops/s]" << std::setw(10) << "capacity" << '\n';
+
+    for (size_t keyCount = 10000; keyCount <= maxKeys; keyCount *= 10){
+        std::vector<std::string> keys = hexIds(2 * keyCount);
+        std::mt19937_64 rng(42);
+        std::vector<size_t> order(2 * keyCount);
+        std::vector<unsigned> operations(2 * keyCount);
+        for (size_t i = 0; i < order.size(); i++){
+            order[i] = rng() % keys.size();
+            operations[i] = (unsigned)(rng() % 100);
+        }
+
+        for (const Engine& engine : engines){
+            hash_map_t* map = hash_map_ctor_with_engine(engine.engine);
+            auto start = Clock::now();
+            for (size_t i = 0; i < keyCount; i++){
+                hash_map_put(map, keys[i].c_str(), (int)i);
+            }
+            double buildMs = elapsedMs(start);
+            std::cout << std::setw(10) << keyCount << std::setw(10) << engine.name << std::setw(10) << "build"
+                      << std::fixed << std::setprecision(2) << std::setw(14) << keyCount / buildMs / 1000
+                      << std::setw(10) << hash_map_capacity(map) << '\n';
+            hash_map_dtor(map);
+
+            for (const Mix& mix : mixes){
+                map = hash_map_ctor_with_engine(engine.engine);
+                for (size_t i = 0; i < keyCount; i++){
+                    hash_map_put(map, keys[i].c_str(), (int)i);
+                }
+
+                long long sum = 0;
+                int value = 0;
+                start = Clock::now();
+                for (size_t i = 0; i < order.size(); i++){
+                    const char* key = keys[order[i]].c_str();
+                    if (operations[i] < mix.getPercent){
+                        if (hash_map_get(map, key, &value) == OK){
+                            sum += value;
+                        }
+                    }
+                    else if (operations[i] < mix.getPercent + mix.putPercent){
+                        hash_map_put(map, key, (int)i);
+                    }
+                    else if (hash_map_pop(map, key, &value) == OK){
+                        sum -= value;
+                    }
+                }
+                double mixMs = elapsedMs(start);
+                std::cout << std::setw(10) << keyCount << std::setw(10) << engine.name << std::setw(10) << mix.name
+                          << std::setw(14) << order.size() / mixMs / 1000 << std::setw(10) << hash_map_capacity(map)
+                          << '\n';
+                hash_map_dtor(map);
+                (void)sum;
+            }
+        }
+    }
+}
+
+// Lookup latency during long put/pop churn of a constant live key count, 100 * maxKeys operations in total
+void benchChurn(size_t maxKeys){
+    size_t liveCount = std::max<size_t>(1000, maxKeys / 10);
+    size_t operationCount = 100 * maxKeys;
+    size_t sampleCount = std::min<size_t>(100000, liveCount);
+    std::cout << "live keys " << liveCount << '\n' << std::setw(10) << "engine" << std::setw(14) << "operations"
+              << std::setw(12) << "capacity" << std::setw(12) << "deleted" << std::setw(14) << "hit [ns]"
+              << std::setw(14) << "miss [ns]" << '\n';
+
+    std::vector<std::string> keys = hexIds(2 * liveCount);
+    for (const Engine& engine : engines){
+        hash_map_t* map = hash_map_ctor_with_engine(engine.engine);
+        std::vector<size_t> live(liveCount), dead(liveCount);
+        for (size_t i = 0; i < liveCount; i++){
+            live[i] = i;
+            dead[i] = liveCount + i;
+            hash_map_put(map, keys[i].c_str(), (int)i);
+        }
+
+        std::mt19937_64 rng(42);
+        size_t done = 0;
+        for (int checkpoint = 1; checkpoint <= 10; checkpoint++){
+            // every step pops a random live key and puts a random removed one back
+            for (; done < operationCount * checkpoint / 10; done += 2){
+                size_t& removed = live[rng() % liveCount];
+                size_t& inserted = dead[rng() % liveCount];
+                hash_map_remove(map, keys[removed].c_str());
+                hash_map_put(map, keys[inserted].c_str(), (int)done);
+                std::swap(removed, inserted);
+            }
+
+            std::vector<size_t> hits(sampleCount), misses(sampleCount);
+            for (size_t i = 0; i < sampleCount; i++){
+                hits[i] = live[rng() % liveCount];
+                misses[i] = dead[rng() % liveCount];
+            }
+            long long sum = 0;
+            int value = 0;
+            auto start = Clock::now();
+            for (size_t i : hits){
+                hash_map_get(map, keys[i].c_str(), &value);
+                sum += value;
+            }
+            double hitNs = elapsedMs(start) * 1e6 / sampleCount;
+            size_t found = 0;
+            start = Clock::now();
+            for (size_t i : misses){
+                found += hash_map_contains(map, keys[i].c_str());
+            }
+            double missNs = elapsedMs(start) * 1e6 / sampleCount;
+
+            std::cout << std::setw(10) << engine.name << std::setw(14) << done << std::setw(12)
+                      << hash_map_capacity(map) << std::setw(12) << map->deleted << std::fixed << std::setprecision(2)
+                      << std::setw(14) << hitNs << std::setw(14) << missNs
+                      << (hash_map_size(map) == liveCount && found == 0 ? "" : "  MISMATCH") << '\n';
+            (void)sum;
+        }
+        hash_map_dtor(map);
+    }
+}
+
+// Loading maxKeys keys into a growing versus a presized map, then one doubling of the full index
+void benchPresize(size_t maxKeys){
+    std::cout << std::setw(10) << "keys" << std::setw(10) << "engine" << std::setw(10) << "presized"
+              << std::setw(12) << "load [ms]" << std::setw(16) << "put [Mops/s]" << std::setw(16) << "rehash [ms]"
+              << '\n';
+
+    std::vector<std::string> keys = hexIds(maxKeys);
+    for (const Engine& engine : engines){
+        for (bool presized : {false, true}){
+            hash_map_config_t config = {};
+            config.engine = engine.engine;
+            config.capacity = presized ? keys.size() : 0;
+            hash_map_t* map = hash_map_ctor_with_config(&config);
+
+            auto start = Clock::now();
+            for (size_t i = 0; i < keys.size(); i++){
+                hash_map_put(map, keys[i].c_str(), (int)i);
+            }
+            double loadMs = elapsedMs(start);
+
+            start = Clock::now();
+            hash_map_reserve(map, 2 * hash_map_capacity(map));
+            double rehashMs = elapsedMs(start);
+
+            std::cout << std::setw(10) << keys.size() << std::setw(10) << engine.name << std::setw(10)
+                      << (presized ? "yes" : "no") << std::fixed << std::setprecision(2) << std::setw(12) << loadMs
+                      << std::setw(16) << keys.size() / loadMs / 1000 << std::setw(16) << rehashMs
+                      << (hash_map_size(map) == keys.size() ? "" : "  MISMATCH") << '\n';
+            hash_map_dtor(map);
+        }
+    }
+}
+
+// Random lookups and updates on a map of maxKeys keys, single calls versus batches of 16-1024 keys
+void benchBatch(size_t maxKeys){
+    size_t queryCount = std::min<size_t>(maxKeys, 2000000);
+    std::cout << std::setw(10) << "keys" << std::setw(10) << "engine" << std::setw(8) << "batch"
+              << std::setw(14) << "get [ns]" << std::setw(14) << "miss [ns]" << std::setw(14) << "put [ns]" << '\n';
+
+    std::vector<std::string> all = hexIds(2 * maxKeys);
+    std::mt19937_64 rng(42);
+    std::vector<const char*> hits(queryCount), misses(queryCount);
+    std::vector<int> values(queryCount);
+    for (size_t i = 0; i < queryCount; i++){
+        hits[i] = all[rng() % maxKeys].c_str();
+        misses[i] = all[maxKeys + rng() % maxKeys].c_str();
+        values[i] = (int)i;
+    }
+
+    for (const Engine& engine : engines){
+        hash_map_config_t config = {};
+        config.engine = engine.engine;
+        config.capacity = maxKeys;
+        hash_map_t* map = hash_map_ctor_with_config(&config);
+        for (size_t i = 0; i < maxKeys; i++){
+            hash_map_put(map, all[i].c_str(), (int)i);
+        }
+
+        std::vector<int> got(queryCount);
+        for (size_t batch : {1, 16, 64, 256, 1024}){
+            size_t found = 0;
+            auto start = Clock::now();
+            for (size_t begin = 0; begin < queryCount; begin += batch){
+                size_t count = std::min(batch, queryCount - begin);
+                if (batch == 1){
+                    found += hash_map_get(map, hits[begin], &got[begin]) == OK;
+                }
+                else {
+                    found += hash_map_get_many(map, &hits[begin], count, &got[begin], NULL);
+                }
+            }
+            double getNs = elapsedMs(start) * 1e6 / queryCount;
+
+            start = Clock::now();
+            for (size_t begin = 0; begin < queryCount; begin += batch){
+                size_t count = std::min(batch, queryCount - begin);
+                if (batch == 1){
+                    found += hash_map_contains(map, misses[begin]);
+                }
+                else {
+                    found += hash_map_contains_many(map, &misses[begin], count, NULL);
+                }
+            }
+            double missNs = elapsedMs(start) * 1e6 / queryCount;
+
+            start = Clock::now();
+            for (size_t begin = 0; begin < queryCount; begin += batch){
+                size_t count = std::min(batch, queryCount - begin);
+                if (batch == 1){
+                    hash_map_put(map, hits[begin], values[begin]);
+                }
+                else {
+                    hash_map_put_many(map, &hits[begin], &values[begin], count, NULL);
+                }
+            }
+            double putNs = elapsedMs(start) * 1e6 / queryCount;
+
+            std::cout << std::setw(10) << maxKeys << std::setw(10) << engine.name << std::setw(8)
+                      << (batch == 1 ? std::string("single") : std::to_string(batch)) << std::fixed
+                      << std::setprecision(2) << std::setw(14) << getNs << std::setw(14) << missNs << std::setw(14)
+                      << putNs << (found == queryCount && hash_map_size(map) == maxKeys ? "" : "  MISMATCH") << '\n';
+        }
+        hash_map_dtor(map);
+    }
+}
+
+// Contains-then-put deduplication of a stream where every key repeats once, hashing per call versus once per key
+void benchHashOnce(size_t maxKeys){
+    std::cout << std::setw(10) << "keys" << std::setw(10) << "key set" << std::setw(16) << "per call [ns]"
+              << std::setw(16) << "hash once [ns]" << '\n';
+
+    for (const KeySet& keySet : keySets){
+        for (size_t keyCount = 10000; keyCount <= maxKeys; keyCount *= 10){
+            std::vector<std::string> keys = keySet.generate(keyCount);
+            std::vector<std::string> stream(keys);
+            stream.insert(stream.end(), keys.begin(), keys.end());
+            std::mt19937_64 rng(42);
+            std::shuffle(stream.begin(), stream.end(), rng);
+
+            double ns[2];
+            size_t unique[2];
+            for (int hashOnce = 0; hashOnce < 2; hashOnce++){
+                hash_map_t* map = hash_map_ctor_with_capacity(keyCount);
+                auto start = Clock::now();
+                for (size_t i = 0; i < stream.size(); i++){
+                    const char* key = stream[i].c_str();
+                    if (hashOnce){
+                        size_t length = stream[i].size();
+                        size_t hash = hash_map_hash_key(map, key, length);
+                        if (!hash_map_contains_hashed(map, key, length, hash)){
+                            hash_map_put_hashed(map, key, length, hash, (int)i);
+                        }
+                    }
+                    else if (!hash_map_contains(map, key)){
+                        hash_map_put(map, key, (int)i);
+                    }
+                }
+                ns[hashOnce] = elapsedMs(start) * 1e6 / stream.size();
+                unique[hashOnce] = hash_map_size(map);
+                hash_map_dtor(map);
+            }
+
+            std::cout << std::setw(10) << keyCount << std::setw(10) << keySet.name << std::fixed
+                      << std::setprecision(2) << std::setw(16) << ns[0] << std::setw(16) << ns[1]
+                      << (unique[0] == keyCount && unique[1] == keyCount ? "" : "  MISMATCH") << '\n';
+        }
+    }
+}
+
+// 64-byte value payload
+struct Payload{
+    uint64_t words[8];
+};
+
+template <typename V>
+V makeValue(size_t i){
+    V value{};
+    std::memcpy(&value, &i, sizeof(i));
+    return value;
+}
+
+template <typename V>
+uint64_t valueWord(const V& value){
+    uint64_t word;
+    std::memcpy(&word, &value, sizeof(word));
+    return word;
+}
+
+// Insert, find and erase of N keys, HashMap<V> versus std::unordered_map<std::string, V>
+template <typename V>
+void benchValuesOf(const char* valueName, const std::vector<std::string>& keys){
+    double hashMapNs[3];
+    double stdNs[3];
+    uint64_t checksum[2] = {0, 0};
+
+    {
+        HashMap<V> map;
+        auto start = Clock::now();
+        for (size_t i = 0; i < keys.size(); i++){
+            map.emplace(keys[i], makeValue<V>(i));
+        }
+        hashMapNs[0] = elapsedMs(start) * 1e6 / keys.size();
+        start = Clock::now();
+        for (const std::string& key : keys){
+            checksum[0] += valueWord(*map.find(key));
+        }
+        hashMapNs[1] = elapsedMs(start) * 1e6 / keys.size();
+        start = Clock::now();
+        for (const std::string& key : keys){
+            map.erase(key);
+        }
+        hashMapNs[2] = elapsedMs(start) * 1e6 / keys.size();
+    }
+    {
+        std::unordered_map<std::string, V> map;
+        auto start = Clock::now();
+        for (size_t i = 0; i < keys.size(); i++){
+            map.emplace(keys[i], makeValue<V>(i));
+        }
+        stdNs[0] = elapsedMs(start) * 1e6 / keys.size();
+        start = Clock::now();
+        for (const std::string& key : keys){
+            checksum[1] += valueWord(map.find(key)->second);
+        }
+        stdNs[1] = elapsedMs(start) * 1e6 / keys.size();
+        start = Clock::now();
+        for (const std::string& key : keys){
+            map.erase(key);
+        }
+        stdNs[2] = elapsedMs(start) * 1e6 / keys.size();
+    }
+
+    std::cout << std::setw(10) << keys.size() << std::setw(8) << valueName << std::fixed << std::setprecision(2);
+    for (int op = 0; op < 3; op++){
+        std::cout << std::setw(12) << hashMapNs[op] << std::setw(12) << stdNs[op];
+    }
+    std::cout << (checksum[0] == checksum[1] ? "" : "  MISMATCH") << '\n';
+}
+
+void benchValues(size_t maxKeys){
+    std::cout << std::setw(10) << "keys" << std::setw(8) << "value" << std::setw(12) << "put [ns]"
+              << std::setw(12) << "std put" << std::setw(12) << "get [ns]" << std::setw(12) << "std get"
+              << std::setw(12) << "pop [ns]" << std::setw(12) << "std pop" << '\n';
+
+    for (size_t keyCount = 10000; keyCount <= maxKeys; keyCount *= 10){
+        std::vector<std::string> keys = hexIds(keyCount);
+        benchValuesOf<uint64_t>("8 B", keys);
+        benchValuesOf<Payload>("64 B", keys);
+    }
+}
+
+// Read percentages of the concurrent mixes, writes are half puts and half pops
+const unsigned concurrentReadPercents[] = {95, 50};
+
+// Multi-threaded get/put/pop throughput, one global mutex around hash_map_t versus hash_map_concurrent_t
+void benchConcurrent(size_t maxKeys){
+    size_t keyCount = std::min<size_t>(maxKeys, 100000);
+    size_t operationCount = 2000000;
+    std::vector<std::string> keys = hexIds(2 * keyCount);
+
+    std::cout << std::setw(10) << "keys" << std::setw(8) << "reads" << std::setw(9) << "threads"
+              << std::setw(16) << "global [Mops/s]" << std::setw(18) << "sharded [Mops/s]" << '\n';
+
+    for (unsigned readPercent : concurrentReadPercents){
+        for (size_t threadCount = 1; threadCount <= 8; threadCount *= 2){
+            double mops[2];
+            for (int sharded = 0; sharded < 2; sharded++){
+                hash_map_t* global = hash_map_ctor_with_capacity(2 * keyCount);
+                std::mutex globalLock;
+                hash_map_concurrent_t* map = hash_map_concurrent_ctor(0, NULL);
+                for (size_t i = 0; i < keyCount; i++){
+                    hash_map_put(global, keys[i].c_str(), (int)i);
+                    hash_map_concurrent_put(map, keys[i].c_str(), (int)i);
+                }
+
+                auto worker = [&](size_t thread){
+                    std::mt19937_64 rng(thread + 1);
+                    size_t count = operationCount / threadCount;
+                    int value = 0;
+                    for (size_t i = 0; i < count; i++){
+                        uint64_t random = rng();
+                        const char* key = keys[(random >> 8) % keys.size()].c_str();
+                        unsigned operation = (unsigned)(random % 200);
+                        if (sharded){
+                            if (operation < 2 * readPercent){
+                                hash_map_concurrent_get(map, key, &value);
+                            }
+                            else if (operation % 2 == 0){
+                                hash_map_concurrent_put(map, key, (int)i);
+                            }
+                            else {
+                                hash_map_concurrent_pop(map, key, &value);
+                            }
+                        }
+                        else {
+                            std::lock_guard<std::mutex> guard(globalLock);
+                            if (operation < 2 * readPercent){
+                                hash_map_get(global, key, &value);
+                            }
+                            else if (operation % 2 == 0){
+                                hash_map_put(global, key, (int)i);
+                            }
+                            else {
+                                hash_map_pop(global, key, &value);
+                            }
+                        }
+                    }
+                };
+
+                auto start = Clock::now();
+                std::vector<std::thread> threads;
+                for (size_t thread = 0; thread < threadCount; thread++){
+                    threads.emplace_back(worker, thread);
+                }
+                for (std::thread& thread : threads){
+                    thread.join();
+                }
+                mops[sharded] = operationCount / elapsedMs(start) / 1000;
+
+                hash_map_concurrent_dtor(map);
+                hash_map_dtor(global);
+            }
+
+            std::cout << std::setw(10) << keyCount << std::setw(7) << readPercent << '%' << std::setw(9)
+                      << threadCount << std::fixed << std::setprecision(2) << std::setw(16) << mops[0]
+                      << std::setw(18) << mops[1] << '\n';
+        }
+    }
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << '\n';
+}
+
+// Percentile of sorted latencies
+double percentile(const std::vector<double>& sorted, double fraction){
+    return sorted[std::min(sorted.size() - 1, (size_t)(fraction * sorted.size()))];
+}
+
+// Put and get latency percentiles while growing from empty to maxKeys, growing at once versus incrementally
+void benchLatency(size_t maxKeys){
+    std::vector<std::string> keys = hexIds(maxKeys);
+
+    std::cout << std::setw(10) << "keys" << std::setw(10) << "engine" << std::setw(13) << "resize"
+              << std::setw(7) << "op" << std::setw(10) << "p50 [ns]" << std::setw(10) << "p99"
+              << std::setw(10) << "p99.9" << std::setw(10) << "p99.99" << std::setw(12) << "max" << '\n';
+
+    for (const Engine& engine : engines){
+        for (int incremental = 0; incremental < 2; incremental++){
+            hash_map_config_t config = {};
+            config.engine = engine.engine;
+            config.incremental = incremental;
+            hash_map_t* map = hash_map_ctor_with_config(&config);
+
+            std::vector<double> putNs(keys.size());
+            std::vector<double> getNs(keys.size());
+            std::mt19937_64 rng(42);
+            int value = 0;
+            size_t found = 0;
+            for (size_t i = 0; i < keys.size(); i++){
+                auto start = Clock::now();
+                hash_map_put(map, keys[i].c_str(), (int)i);
+                putNs[i] = elapsedMs(start) * 1e6;
+
+                const char* key = keys[rng() % (i + 1)].c_str();
+                start = Clock::now();
+                found += hash_map_get(map, key, &value) == OK;
+                getNs[i] = elapsedMs(start) * 1e6;
+            }
+            hash_map_dtor(map);
+
+            const char* names[] = {"put", "get"};
+            std::vector<double>* latencies[] = {&putNs, &getNs};
+            for (int op = 0; op < 2; op++){
+                std::vector<double>& sorted = *latencies[op];
+                std::sort(sorted.begin(), sorted.end());
+                std::cout << std::setw(10) << keys.size() << std::setw(10) << engine.name << std::setw(13)
+                          << (incremental ? "incremental" : "at once") << std::setw(7) << names[op] << std::fixed
+                          << std::setprecision(0) << std::setw(10) << percentile(sorted, 0.5) << std::setw(10)
+                          << percentile(sorted, 0.99) << std::setw(10) << percentile(sorted, 0.999) << std::setw(10)
+                          << percentile(sorted, 0.9999) << std::setw(12) << sorted.back()
+                          << (found == keys.size() ? "" : "  MISMATCH") << '\n';
+            }
+        }
+    }
+}
+
+// Heap bytes in use including mmapped blocks, 0 when the allocator cannot report it
+size_t heapInUse(){
+#ifdef WHITE_BOX_COUNT_MALLOC
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+// Item layouts of benchIterate
+struct Layout{
+    const char* name;
+    bool arena;
+    bool compact;
+};
+
+const Layout layouts[] = {
+    {"malloc", false, false},
+    {"arena", true, false},
+    {"compact", false, true},
+};
+
+// Full iteration in insertion order and heap bytes per entry after churn (half the keys replaced)
+void benchIterate(size_t maxKeys){
+    std::cout << std::setw(10) << "keys" << std::setw(10) << "layout" << std::setw(14) << "iter [ns]"
+              << std::setw(14) << "range [ns]" << std::setw(14) << "bytes/entry" << '\n';
+
+    for (size_t keyCount = 10000; keyCount <= maxKeys; keyCount *= 10){
+        std::vector<std::string> keys = hexIds(keyCount + keyCount / 2);
+        std::vector<size_t> removed(keyCount);
+        for (size_t i = 0; i < keyCount; i++){
+            removed[i] = i;
+        }
+        std::mt19937_64 rng(42);
+        std::shuffle(removed.begin(), removed.end(), rng);
+        removed.resize(keyCount / 2);
+
+        for (const Layout& layout : layouts){
+            size_t heapBefore = heapInUse();
+            hash_map_config_t config = {};
+            config.arena = layout.arena;
+            hash_map_t* map = hash_map_ctor_with_config(&config);
+            for (size_t i = 0; i < keyCount; i++){
+                hash_map_put(map, keys[i].c_str(), (int)i);
+            }
+            for (size_t i : removed){
+                hash_map_remove(map, keys[i].c_str());
+            }
+            for (size_t i = keyCount; i < keys.size(); i++){
+                hash_map_put(map, keys[i].c_str(), (int)i);
+            }
+            if (layout.compact){
+                hash_map_compact(map);
+            }
+            double bytes = (double)(heapInUse() - heapBefore) / hash_map_size(map);
+
+            const int passes = 10;
+            long long sum = 0;
+            auto start = Clock::now();
+            for (int pass = 0; pass < passes; pass++){
+                hash_map_iter_t iter = hash_map_iter_begin(map);
+                int value;
+                while (hash_map_iter_next(&iter, NULL, NULL, &value)){
+                    sum += value;
+                }
+            }
+            double iterNs = elapsedMs(start) * 1e6 / passes / hash_map_size(map);
+
+            start = Clock::now();
+            for (int pass = 0; pass < passes; pass++){
+                for (auto [key, value] : hash_map_items(map)){
+                    sum -= value + (long long)key.size();
+                }
+            }
+            double rangeNs = elapsedMs(start) * 1e6 / passes / hash_map_size(map);
+
+            std::cout << std::setw(10) << keyCount << std::setw(10) << layout.name << std::fixed << std::setprecision(2)
+                      << std::setw(14) << iterNs << std::setw(14) << rangeNs << std::setw(14);
+#ifdef WHITE_BOX_COUNT_MALLOC
+            std::cout << std::setprecision(1) << bytes;
+#else
+            std::cout << "n/a";
+            (void)bytes;
+#endif
+            std::cout << (sum == -(long long)passes * 32 * (long long)hash_map_size(map) ? "" : "  MISMATCH") << '\n';
+            hash_map_dtor(map);
+        }
+    }
+}
+
+// Cost of hash_map_stats with and without the probe scan, and what it reports for both hash functions
+void benchStats(size_t maxKeys){
+    std::cout << std::setw(10) << "keys" << std::setw(10) << "hash" << std::setw(8) << "load" << std::setw(10)
+              << "probes" << std::setw(8) << "max" << std::setw(14) << "bytes/entry" << std::setw(14) << "stats [ns]"
+              << std::setw(14) << "scan [ms]" << '\n';
+
+    // Hash function cut short on a smaller set is not measured on larger sets
+    std::vector<bool> cutShort(sizeof(hashFunctions) / sizeof(hashFunctions[0]), false);
+    for (size_t keyCount = 10000; keyCount <= maxKeys; keyCount *= 10){
+        std::vector<std::string> keys = sequentialIds(keyCount);
+        for (size_t h = 0; h < cutShort.size(); h++){
+            const HashFunction& hashFunction = hashFunctions[h];
+            if (cutShort[h]){
+                continue;
+            }
+            hash_map_config_t config = {};
+            config.hash_function = hashFunction.function;
+            hash_map_t* map = hash_map_ctor_with_config(&config);
+            auto start = Clock::now();
+            for (size_t i = 0; i < keys.size(); i++){
+                hash_map_put(map, keys[i].c_str(), (int)i);
+                // The additive hash degrades quadratically on large sets
+                if (i % 1000 == 0 && elapsedMs(start) > 2000){
+                    cutShort[h] = true;
+                    break;
+                }
+            }
+
+            hash_map_stats_t stats;
+            const int calls = 100000;
+            size_t checksum = 0;
+            start = Clock::now();
+            for (int call = 0; call < calls; call++){
+                hash_map_stats(map, &stats, false);
+                checksum += stats.total_bytes;
+            }
+            double statsNs = elapsedMs(start) * 1e6 / calls;
+
+            start = Clock::now();
+            hash_map_stats(map, &stats, true);
+            double scanMs = elapsedMs(start);
+
+            std::cout << std::setw(10) << stats.size << std::setw(10) << hashFunction.name << std::fixed
+                      << std::setprecision(2) << std::setw(8) << stats.load_factor << std::setw(10)
+                      << stats.probe_average << std::setw(8) << stats.probe_max << std::setprecision(1)
+                      << std::setw(14) << (double)stats.total_bytes / stats.size << std::setprecision(1)
+                      << std::setw(14) << statsNs << std::setprecision(2) << std::setw(14) << scanMs
+                      << (checksum == calls * stats.total_bytes ? "" : "  MISMATCH") << '\n';
+            hash_map_dtor(map);
+        }
+    }
+}
+
+// Drops the file from the page cache where supported, the next open then reads it from disk
+bool evictFromPageCache(const std::string& path){
+#if !defined(_WIN32) && defined(POSIX_FADV_DONTNEED)
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0){
+        return false;
+    }
+    bool evicted = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    close(fd);
+    return evicted;
+#else
+    (void)path;
+    return false;
+#endif
+}
+
+// Startup to first query, rebuilding with puts versus opening a saved file, and lookups on both
+void benchMapped(size_t maxKeys){
+    std::vector<std::string> keys = sequentialIds(maxKeys);
+    std::string path = (std::filesystem::temp_directory_path() / "white_box_benchmark.bin").string();
+    size_t queryCount = std::min<size_t>(1000000, keys.size());
+    std::mt19937_64 rng(42);
+    std::vector<const char*> queries(queryCount);
+    for (const char*& query : queries){
+        query = keys[rng() % keys.size()].c_str();
+    }
+
+    std::cout << std::setw(10) << "keys" << std::setw(12) << "startup" << std::setw(18) << "first query [ms]"
+              << std::setw(14) << "get [ns]" << '\n';
+
+    int value = 0;
+    auto start = Clock::now();
+    hash_map_t* map = hash_map_ctor();
+    for (size_t i = 0; i < keys.size(); i++){
+        hash_map_put(map, keys[i].c_str(), (int)i);
+    }
+    bool found = hash_map_get(map, keys.back().c_str(), &value) == OK;
+    double rebuildMs = elapsedMs(start);
+
+    start = Clock::now();
+    for (const char* query : queries){
+        found &= hash_map_get(map, query, &value) == OK;
+    }
+    double getNs = elapsedMs(start) * 1e6 / queryCount;
+    std::cout << std::setw(10) << keys.size() << std::setw(12) << "rebuild" << std::fixed << std::setprecision(2)
+              << std::setw(18) << rebuildMs << std::setw(14) << getNs << '\n';
+
+    start = Clock::now();
+    bool saved = hash_map_save(map, path.c_str()) == OK;
+    double saveMs = elapsedMs(start);
+    hash_map_dtor(map);
+
+    for (int cold = 0; cold < 2 && saved; cold++){
+        if (cold && !evictFromPageCache(path)){
+            break;
+        }
+        start = Clock::now();
+        hash_map_mapped_t* mapped = hash_map_open_mapped(path.c_str(), NULL);
+        found &= mapped != NULL && hash_map_mapped_get(mapped, keys.back().c_str(), &value) == OK;
+        double openMs = elapsedMs(start);
+        if (mapped == NULL){
+            break;
+        }
+
+        start = Clock::now();
+        for (const char* query : queries){
+            found &= hash_map_mapped_get(mapped, query, &value) == OK;
+        }
+        getNs = elapsedMs(start) * 1e6 / queryCount;
+        std::cout << std::setw(10) << keys.size() << std::setw(12) << (cold ? "mmap cold" : "mmap warm")
+                  << std::setw(18) << openMs << std::setw(14) << getNs << '\n';
+        hash_map_mapped_close(mapped);
+    }
+
+    std::cout << "save [ms]: " << saveMs << ", file [MB]: "
+              << (saved ? std::filesystem::file_size(path) / 1e6 : 0.0) << (saved && found ? "" : "  MISMATCH") << '\n';
+    std::remove(path.c_str());
+}
+
+struct Benchmark{
+    const char* name;
+    void (*run)(size_t maxKeys);
+};
+
+const Benchmark benchmarks[] = {
+    {"hash", benchHash},
+    {"keys", benchKeys},
+    {"arena", benchArena},
+    {"load", benchLoad},
+    {"engines", benchEngines},
+    {"churn", benchChurn},
+    {"presize", benchPresize},
+    {"batch", benchBatch},
+    {"hashonce", benchHashOnce},
+    {"values", benchValues},
+    {"concurrent", benchConcurrent},
+    {"latency", benchLatency},
+    {"iterate", benchIterate},
+    {"stats", benchStats},
+    {"mapped", benchMapped},
+};
+
+} // namespace
+
+int main(int argc, char* argv[]){
+    const char* selected = argc > 1 ? argv[1] : "all";
+    size_t maxKeys = argc > 2 ? std::stoull(argv[2]) : 1000000;
+
+    bool matched = false;
+    for (const Benchmark& benchmark : benchmarks){
+        if (std::strcmp(selected, "all") == 0 || std::strcmp(selected, benchmark.name) == 0){
+            std::cout << "== " << benchmark.name << " ==\n";
+            benchmark.run(maxKeys);
+            matched = true;
+        }
+    }
+
+    if (!matched){
+        std::cerr << "Unknown benchmark: " << selected << '\n';
+        return 1;
+    }
+    return 0;
+}
+
+/*** Konec souboru white_box_benchmark.cpp ***/
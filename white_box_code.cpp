@@ -16,29 +16,480 @@
  */
 
 #include "white_box_code.h"
+#include <limits.h>
 #include <stdio.h>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define HASH_MAP_GROUP_SSE2
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define HASH_MAP_PREFETCH(address) __builtin_prefetch(address)
+#elif defined(HASH_MAP_GROUP_SSE2)
+#define HASH_MAP_PREFETCH(address) _mm_prefetch((const char*)(address), _MM_HINT_T0)
+#else
+#define HASH_MAP_PREFETCH(address) ((void)(address))
+#endif
 
 /*******************************************************************************
  * Pomocné metody.
  ******************************************************************************/
+/** Konstanty míchání hašovací funkce hash_map_hash_wy. */
+static const uint64_t HASH_WY_SECRET[4] = {
+    0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL,
+    0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL
+};
+
 /**
- * @brief Výpočet haše pro zadaný řetězec.
+ * @brief Úplný 128bitový součin dvou 64bitových čísel.
  *
- * @param[in] str klíč
- * @return hash 
+ * @param[in,out] a Činitel, po návratu dolních 64 bitů součinu.
+ * @param[in,out] b Činitel, po návratu horních 64 bitů součinu.
+ */
+static inline void hash_wy_mum(uint64_t* a, uint64_t* b)
+{
+#ifdef __SIZEOF_INT128__
+    __uint128_t product = (__uint128_t)*a * *b;
+    *a = (uint64_t)product;
+    *b = (uint64_t)(product >> 64);
+#else
+    uint64_t a_high = *a >> 32, a_low = (uint32_t)*a;
+    uint64_t b_high = *b >> 32, b_low = (uint32_t)*b;
+    uint64_t high = a_high * b_high, middle0 = a_high * b_low;
+    uint64_t middle1 = a_low * b_high, low = a_low * b_low;
+    uint64_t carry = (uint64_t)(uint32_t)middle0 + (uint32_t)middle1 + (low >> 32);
+    *a = (low & 0xffffffffULL) | (carry << 32);
+    *b = high + (middle0 >> 32) + (middle1 >> 32) + (carry >> 32);
+#endif
+}
+
+/**
+ * @brief Smíchání dvou čísel, XOR dolní a horní poloviny jejich součinu.
  */
-size_t hash_function(const char* str)
+static inline uint64_t hash_wy_mix(uint64_t a, uint64_t b)
+{
+    hash_wy_mum(&a, &b);
+    return a ^ b;
+}
+
+/** @brief Čtení 8 bajtů z libovolně zarovnané adresy. */
+static inline uint64_t hash_wy_read8(const char* p)
+{
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+/** @brief Čtení 4 bajtů z libovolně zarovnané adresy. */
+static inline uint64_t hash_wy_read4(const char* p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+size_t hash_map_hash_additive(const char* key, size_t length, size_t seed)
 {
     size_t hash = 0;
+    (void)seed;
 
-    for (size_t idx = 0; str[idx] != '\0'; idx++)
+    for (size_t idx = 0; idx < length; idx++)
     {
-        hash += HASH_FUNCTION_PARAM_A*str[idx] + HASH_FUNCTION_PARAM_B;
+        hash += HASH_FUNCTION_PARAM_A*key[idx] + HASH_FUNCTION_PARAM_B;
     }
 
     return hash;
 }
 
+size_t hash_map_hash_wy(const char* key, size_t length, size_t seed)
+{
+    const char* p = key;
+    uint64_t state = seed ^ hash_wy_mix(seed ^ HASH_WY_SECRET[0], HASH_WY_SECRET[1]);
+    uint64_t a, b;
+
+    if (length <= 16)
+    {
+        if (length >= 4)
+        {
+            // dve prekryvajici se dvojice ctyrbajtovych cteni pokryji cely klic
+            size_t shift = (length >> 3) << 2;
+            a = (hash_wy_read4(p) << 32) | hash_wy_read4(p + shift);
+            b = (hash_wy_read4(p + length - 4) << 32) | hash_wy_read4(p + length - 4 - shift);
+        }
+        else if (length > 0)
+        {
+            a = ((uint64_t)(unsigned char)p[0] << 16) |
+                ((uint64_t)(unsigned char)p[length >> 1] << 8) |
+                (unsigned char)p[length - 1];
+            b = 0;
+        }
+        else
+        {
+            a = b = 0;
+        }
+    }
+    else
+    {
+        size_t remaining = length;
+        if (remaining > 48)
+        {
+            // tri nezavisle proudy pro delsi klice
+            uint64_t state1 = state, state2 = state;
+            do
+            {
+                state = hash_wy_mix(hash_wy_read8(p) ^ HASH_WY_SECRET[1], hash_wy_read8(p + 8) ^ state);
+                state1 = hash_wy_mix(hash_wy_read8(p + 16) ^ HASH_WY_SECRET[2], hash_wy_read8(p + 24) ^ state1);
+                state2 = hash_wy_mix(hash_wy_read8(p + 32) ^ HASH_WY_SECRET[3], hash_wy_read8(p + 40) ^ state2);
+                p += 48;
+                remaining -= 48;
+            } while (remaining > 48);
+            state ^= state1 ^ state2;
+        }
+        while (remaining > 16)
+        {
+            state = hash_wy_mix(hash_wy_read8(p) ^ HASH_WY_SECRET[1], hash_wy_read8(p + 8) ^ state);
+            p += 16;
+            remaining -= 16;
+        }
+        // poslednich 16 bajtu, muze se prekryvat s jiz zpracovanymi
+        a = hash_wy_read8(p + remaining - 16);
+        b = hash_wy_read8(p + remaining - 8);
+    }
+
+    a ^= HASH_WY_SECRET[1];
+    b ^= state;
+    hash_wy_mum(&a, &b);
+    return (size_t)hash_wy_mix(a ^ HASH_WY_SECRET[0] ^ length, b ^ HASH_WY_SECRET[1]);
+}
+
+
+/** Velikost hlavičky bloku areny zaokrouhlená na zarovnání položek. */
+static const size_t HASH_MAP_ARENA_HEADER =
+    (sizeof(hash_map_arena_chunk_t) + HASH_MAP_ARENA_ALIGN - 1) & ~(size_t)(HASH_MAP_ARENA_ALIGN - 1);
+
+/** Začátek hodnoty v bloku položky, za strukturou položky se zarovnáním. */
+static const size_t HASH_MAP_VALUE_OFFSET =
+    (sizeof(hash_map_item_t) + HASH_MAP_VALUE_ALIGN - 1) & ~(size_t)(HASH_MAP_VALUE_ALIGN - 1);
+
+/**
+ * @brief Začátek klíče v bloku položky.
+ *
+ * Bez hodnot (@c value_size 0) leží klíč hned za strukturou položky, jinak
+ * za hodnotou.
+ */
+static inline size_t hash_map_key_offset(const hash_map_t* self)
+{
+    return self->value_size == 0 ? sizeof(hash_map_item_t) : HASH_MAP_VALUE_OFFSET + self->value_size;
+}
+
+/**
+ * @brief Velikost bloku paměti pro položku s klíčem dané délky v areně.
+ *
+ * @param[in] self   Ukazatel na strukturu hašovací tabulky.
+ * @param[in] length Délka klíče.
+ * @return Velikost zaokrouhlená na násobek @c HASH_MAP_ARENA_ALIGN.
+ */
+static inline size_t hash_map_arena_item_size(const hash_map_t* self, size_t length)
+{
+    size_t size = hash_map_key_offset(self) + length + 1;
+    return (size + HASH_MAP_ARENA_ALIGN - 1) & ~(size_t)(HASH_MAP_ARENA_ALIGN - 1);
+}
+
+/**
+ * @brief Přidělí paměť pro položku s klíčem dané délky.
+ *
+ * Bez areny alokuje položku pomocí @c malloc, jinak ji vezme ze seznamu
+ * volných položek nebo z posledního bloku areny, případně alokuje nový blok.
+ *
+ * @param[in] self   Ukazatel na strukturu hašovací tabulky.
+ * @param[in] length Délka klíče.
+ * @return Neinicializovaná položka nebo @c NULL při chybě alokace.
+ */
+static hash_map_item_t* hash_map_item_alloc(hash_map_t* self, size_t length)
+{
+    hash_map_arena_t* arena = self->arena;
+    if (arena == NULL)
+    {
+        return (hash_map_item_t*)malloc(hash_map_key_offset(self) + length + 1);
+    }
+
+    size_t size = hash_map_arena_item_size(self, length);
+    size_t size_class = size / HASH_MAP_ARENA_ALIGN;
+    if (size_class < HASH_MAP_ARENA_CLASSES && arena->free_items[size_class] != NULL)
+    {
+        // znovupouziti drive odebrane polozky stejne velikosti
+        hash_map_item_t* item = arena->free_items[size_class];
+        arena->free_items[size_class] = item->next;
+        return item;
+    }
+
+    if (arena->remaining < size)
+    {
+        // novy blok, kazdy dalsi je dvakrat vetsi
+        size_t chunk_size = arena->chunks == NULL ? HASH_MAP_ARENA_FIRST_CHUNK : arena->chunks->size * 2;
+        if (chunk_size > HASH_MAP_ARENA_MAX_CHUNK)
+        {
+            chunk_size = HASH_MAP_ARENA_MAX_CHUNK;
+        }
+        if (chunk_size < size)
+        {
+            chunk_size = size;
+        }
+
+        hash_map_arena_chunk_t* chunk = (hash_map_arena_chunk_t*)malloc(HASH_MAP_ARENA_HEADER + chunk_size);
+        if (chunk == NULL)
+        {
+            return NULL;
+        }
+        chunk->next = arena->chunks;
+        chunk->size = chunk_size;
+        arena->chunks = chunk;
+        arena->cursor = (char*)chunk + HASH_MAP_ARENA_HEADER;
+        arena->remaining = chunk_size;
+    }
+
+    hash_map_item_t* item = (hash_map_item_t*)arena->cursor;
+    arena->cursor += size;
+    arena->remaining -= size;
+    return item;
+}
+
+/**
+ * @brief Uvolní paměť položky přidělené funkcí @c hash_map_item_alloc.
+ *
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ * @param[in] item Položka, jejíž klíč je stále platný.
+ */
+static void hash_map_item_free(hash_map_t* self, hash_map_item_t* item)
+{
+    hash_map_arena_t* arena = self->arena;
+    if (arena == NULL)
+    {
+        free(item);
+        return;
+    }
+
+    size_t size_class = hash_map_arena_item_size(self, item->length) / HASH_MAP_ARENA_ALIGN;
+    if (size_class < HASH_MAP_ARENA_CLASSES)
+    {
+        item->next = arena->free_items[size_class];
+        arena->free_items[size_class] = item;
+    }
+}
+
+/**
+ * @brief Uvolní všechny bloky areny kromě posledního, který se vyprázdní.
+ *
+ * @param[in] arena Arena hašovací tabulky.
+ * @param[in] keep_last Pokud @c true, poslední (největší) blok se ponechá pro
+ *                      další vkládání, jinak se uvolní také.
+ */
+static void hash_map_arena_release(hash_map_arena_t* arena, bool keep_last)
+{
+    hash_map_arena_chunk_t* chunk = arena->chunks;
+    hash_map_arena_chunk_t* kept = NULL;
+    if (keep_last && chunk != NULL)
+    {
+        kept = chunk;
+        chunk = chunk->next;
+        kept->next = NULL;
+    }
+    while (chunk != NULL)
+    {
+        hash_map_arena_chunk_t* next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+
+    memset(arena, 0, sizeof(*arena));
+    if (kept != NULL)
+    {
+        arena->chunks = kept;
+        arena->cursor = (char*)kept + HASH_MAP_ARENA_HEADER;
+        arena->remaining = kept->size;
+    }
+}
+
+/**
+ * @brief Otisk haše ukládaný do pole tags.
+ *
+ * Horních 8 bitů součinu s lichou konstantou závisí na všech bitech haše,
+ * takže otisky se liší i u hašů, které se liší jen v dolních bitech.
+ *
+ * @param[in] hash Haš klíče.
+ * @return Otisk haše.
+ */
+static inline unsigned char hash_map_tag(size_t hash)
+{
+    return (unsigned char)(((uint64_t)hash * 0x9e3779b97f4a7c15ULL) >> 56);
+}
+
+/** Otisk volné pozice u @c HASH_MAP_ENGINE_GROUP. */
+static const unsigned char HASH_MAP_CTRL_EMPTY = 0x80;
+/** Otisk odstraněné pozice u @c HASH_MAP_ENGINE_GROUP. */
+static const unsigned char HASH_MAP_CTRL_DELETED = 0xfe;
+
+/**
+ * @brief Otisk obsazené pozice podle způsobu prohledávání tabulky.
+ *
+ * Skupinové prohledávání používá jen 7 bitů, aby se obsazené pozice lišily od
+ * volných a odstraněných nejvyšším bitem.
+ */
+static inline unsigned char hash_map_slot_tag(const hash_map_t* self, size_t hash)
+{
+    unsigned char tag = hash_map_tag(hash);
+    return self->engine == HASH_MAP_ENGINE_GROUP ? (unsigned char)(tag >> 1) : tag;
+}
+
+/**
+ * @brief Bitová maska pozic skupiny, jejichž otisk je roven @p tag .
+ *
+ * @param[in] ctrl Otisky skupiny, @c HASH_MAP_GROUP_WIDTH bajtů.
+ * @param[in] tag  Hledaný otisk.
+ * @return Maska, i-tý bit odpovídá i-té pozici skupiny.
+ */
+static inline unsigned hash_map_group_match(const unsigned char* ctrl, unsigned char tag)
+{
+#ifdef HASH_MAP_GROUP_SSE2
+    __m128i group = _mm_loadu_si128((const __m128i*)ctrl);
+    return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)tag)));
+#else
+    unsigned mask = 0;
+    for (unsigned i = 0; i < HASH_MAP_GROUP_WIDTH; i++)
+    {
+        mask |= (unsigned)(ctrl[i] == tag) << i;
+    }
+    return mask;
+#endif
+}
+
+/**
+ * @brief Bitová maska volných a odstraněných pozic skupiny.
+ *
+ * @param[in] ctrl Otisky skupiny, @c HASH_MAP_GROUP_WIDTH bajtů.
+ * @return Maska pozic s nastaveným nejvyšším bitem otisku.
+ */
+static inline unsigned hash_map_group_match_free(const unsigned char* ctrl)
+{
+#ifdef HASH_MAP_GROUP_SSE2
+    return (unsigned)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)ctrl));
+#else
+    unsigned mask = 0;
+    for (unsigned i = 0; i < HASH_MAP_GROUP_WIDTH; i++)
+    {
+        mask |= (unsigned)(ctrl[i] >> 7) << i;
+    }
+    return mask;
+#endif
+}
+
+/** @brief Pořadí nejnižšího nastaveného bitu nenulové masky. */
+static inline unsigned hash_map_lowest_bit(unsigned mask)
+{
+#ifdef _MSC_VER
+    unsigned long bit;
+    _BitScanForward(&bit, mask);
+    return (unsigned)bit;
+#else
+    return (unsigned)__builtin_ctz(mask);
+#endif
+}
+
+/**
+ * @brief Vyhledání klíče po skupinách pozic (@c HASH_MAP_ENGINE_GROUP).
+ *
+ * Ve skupině se položky čtou jen na pozicích se shodným otiskem. Hledání končí
+ * ve skupině, která obsahuje volnou pozici, protože vkládání do ní by žádný
+ * klíč nepřeskočilo. Index má vždy alespoň jednu volnou pozici.
+ *
+ * @param[in] self   Ukazatel na strukturu hašovací tabulky.
+ * @param[in] key    Klíč.
+ * @param[in] length Délka klíče.
+ * @param[in] hash   Haš zadaného klíče.
+ *
+ * @return Index záznamu asociovaný k zadanému klíči, nebo volné místo v tabulce.
+ */
+static size_t hash_map_group_lookup(hash_map_t* self, const char* key, size_t length,
+                                    size_t hash)
+{
+    size_t groups = self->allocated / HASH_MAP_GROUP_WIDTH;
+    size_t group = hash % groups;
+    unsigned char tag = hash_map_slot_tag(self, hash);
+#ifdef HASH_MAP_STATS
+    self->lookups++;
+#endif
+
+    while (true)
+    {
+#ifdef HASH_MAP_STATS
+        self->lookup_probes++;
+#endif
+        const unsigned char* ctrl = self->tags + group * HASH_MAP_GROUP_WIDTH;
+        unsigned mask = hash_map_group_match(ctrl, tag);
+        while (mask != 0)
+        {
+            size_t idx = group * HASH_MAP_GROUP_WIDTH + hash_map_lowest_bit(mask);
+            hash_map_item_t* item = self->index[idx];
+            if (item->hash == hash && item->length == length &&
+                memcmp(item->key, key, length) == 0)
+            {
+                return idx;
+            }
+            mask &= mask - 1;
+        }
+
+        mask = hash_map_group_match(ctrl, HASH_MAP_CTRL_EMPTY);
+        if (mask != 0)
+        {
+            return group * HASH_MAP_GROUP_WIDTH + hash_map_lowest_bit(mask);
+        }
+        if (++group == groups)
+        {
+            group = 0;
+        }
+    }
+}
+
+/**
+ * @brief První volná nebo odstraněná pozice na cestě haše (@c HASH_MAP_ENGINE_GROUP).
+ *
+ * Klíče se neporovnávají, volající musí vědět, že klíč v tabulce není.
+ *
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ * @param[in] hash Haš vkládaného klíče.
+ *
+ * @return Index pozice pro vložení.
+ */
+static size_t hash_map_group_free_slot(hash_map_t* self, size_t hash)
+{
+    size_t groups = self->allocated / HASH_MAP_GROUP_WIDTH;
+    size_t group = hash % groups;
+    unsigned mask;
+
+    while ((mask = hash_map_group_match_free(self->tags + group * HASH_MAP_GROUP_WIDTH)) == 0)
+    {
+        if (++group == groups)
+        {
+            group = 0;
+        }
+    }
+    return group * HASH_MAP_GROUP_WIDTH + hash_map_lowest_bit(mask);
+}
+
 /**
  * @brief Výpočet indexu v hašovací tabulce v závislosti na dvojici klíč-hash.
  * 
@@ -51,6 +502,7 @@ size_t hash_function(const char* str)
  *
  * @param[in] self         Ukazatel na strukturu hašovací tabulky.
  * @param[in] str          Klíč.
+ * @param[in] length       Délka klíče.
  * @param[in] str          Haš zadaného klíče.
  * @param[in] ignore_dummy Pokud @c true, @c dummy objekt je vždy přeskočen,
  *                         pokud @c false, @c dummy objekt je interpretován jako
@@ -59,26 +511,37 @@ size_t hash_function(const char* str)
  * @return Index záznamu asociovaný k zadanému klíči a haši, nebo prázdné místo
  *         v tabulce.
  */
-size_t hash_map_lookup_handle(hash_map_t* self, const char* key, size_t hash, 
-                              bool ignore_dummy)
+size_t hash_map_lookup_handle(hash_map_t* self, const char* key, size_t length,
+                              size_t hash, bool ignore_dummy)
 {
     size_t idx = hash % self->allocated;
     size_t perturb = hash;
+    unsigned char tag = hash_map_tag(hash);
+#ifdef HASH_MAP_STATS
+    self->lookups++;
+    self->lookup_probes++;
+#endif
 
+    // polozka se cte az kdyz souhlasi otisk v indexu
     while ( 
         (self->index[idx] != NULL && 
         (ignore_dummy || self->index[idx] != self->dummy)) &&
         (
             self->index[idx] == self->dummy ||
             (
+                (self->tags[idx] != tag) ||
                 (self->index[idx]->hash != hash) || 
-                (strcmp(self->index[idx]->key, key) != 0)
+                (self->index[idx]->length != length) ||
+                (memcmp(self->index[idx]->key, key, length) != 0)
             )
         )
     )
     {
         idx = ((idx << 2) + idx + perturb + 1) % self->allocated;
         perturb >>= HASH_MAP_PERTURB_SHIFT;
+#ifdef HASH_MAP_STATS
+        self->lookup_probes++;
+#endif
     }
 
     return idx;
@@ -86,280 +549,1652 @@ size_t hash_map_lookup_handle(hash_map_t* self, const char* key, size_t hash,
 /**
  * @brief Výpočet indexu v hašovací tabulce v závislosti na dvojici klíč-hash.
  *
- * @param[in] self Ukazatel na strukturu hašovací tabulky.
- * @param[in] str  Klíč.
- * @param[in] str  Haš zadaného klíče.
+ * @param[in] self   Ukazatel na strukturu hašovací tabulky.
+ * @param[in] str    Klíč.
+ * @param[in] length Délka klíče.
+ * @param[in] str    Haš zadaného klíče.
  * 
  * @return Index záznamu asociovaný k zadanému klíči a haši, nebo prázdné místo
  *         v tabulce.
  * 
  * @see hash_map_lookup_handle
  */
-size_t hash_map_lookup(hash_map_t* self, const char* key, size_t hash)
+size_t hash_map_lookup(hash_map_t* self, const char* key, size_t length, size_t hash)
 {
-    return hash_map_lookup_handle(self, key, hash, true);
+    return hash_map_lookup_handle(self, key, length, hash, true);
 }
 
 /**
- * @brief Inicializace hašovací tabulky.
- * 
- * Metoda alokuje a inicializuje položky struktury hašovací tabulky.
- * 
- * @param self[in] Ukazatel na neinicializovanou hašovací tabulku
- * @param size[in] Počet prvků v tabulce.
- * 
- * @return @c MEMORY_ERROR v případě chyby v alokaci paměti, jinak @c OK.
+ * @brief Volná pozice pro haš v indexu bez odstraněných pozic (@c HASH_MAP_ENGINE_PERTURB).
+ *
+ * Používá se při přestavbě indexu, kdy jsou všechny klíče různé a index
+ * neobsahuje @c dummy, takže stačí najít první prázdné místo bez čtení
+ * položek.
+ *
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ * @param[in] hash Haš vkládaného klíče.
+ *
+ * @return Index prázdného místa.
  */
-hash_map_state_code_t hash_map_init(hash_map_t* self, size_t size)
+static inline size_t hash_map_perturb_free_slot(hash_map_t* self, size_t hash)
 {
-    self->dummy = (hash_map_item_t*)malloc(sizeof(hash_map_item_t));
-    self->first = self->last = NULL;
-    self->used = 0;
-    self->allocated = 0;
-    self->index = NULL;
-    
-    if (hash_map_reserve(self, size) == MEMORY_ERROR)
+    size_t idx = hash % self->allocated;
+    size_t perturb = hash;
+
+    while (self->index[idx] != NULL)
     {
-        free(self->dummy);
-        return MEMORY_ERROR;
+        idx = ((idx << 2) + idx + perturb + 1) % self->allocated;
+        perturb >>= HASH_MAP_PERTURB_SHIFT;
     }
-
-    return OK;
+    return idx;
 }
 
-/*******************************************************************************
- * Definice veřejných metod.
- ******************************************************************************/
-
-hash_map_t* hash_map_ctor()
+/**
+ * @brief Vyhledání klíče způsobem prohledávání zvoleným pro tabulku.
+ *
+ * @see hash_map_lookup, hash_map_group_lookup
+ */
+static inline size_t hash_map_find(hash_map_t* self, const char* key, size_t length,
+                                   size_t hash)
 {
-    hash_map_t* map = (hash_map_t*)malloc(sizeof(hash_map_t));
-    if (map != NULL && hash_map_init(map, HASH_MAP_INIT_SIZE) == MEMORY_ERROR) 
+    if (self->engine == HASH_MAP_ENGINE_GROUP)
     {
-        free(map);
-        map = NULL;
+        return hash_map_group_lookup(self, key, length, hash);
     }
-    return map;
+    return hash_map_lookup(self, key, length, hash);
 }
 
-void hash_map_clear(hash_map_t* self)
+/**
+ * @brief Tabulka, jejíž index je starý index postupného zvětšování.
+ *
+ * Vyhledávací funkce tak lze použít i na starý index.
+ *
+ * @param[in]  self Ukazatel na strukturu hašovací tabulky.
+ * @param[out] view Kopie tabulky se starým indexem.
+ */
+static inline void hash_map_old_view(const hash_map_t* self, hash_map_t* view)
 {
-    size_t idx;
-    hash_map_item_t* item = self->first;
-    hash_map_item_t* curr_item;
-    while (item != NULL)
-    {
-        curr_item = item;
-        item = item->next;
-        free(curr_item->key);
-        free(curr_item);
-    }
+    *view = *self;
+    view->index = self->old_index;
+    view->tags = self->old_tags;
+    view->allocated = self->old_allocated;
+}
 
-    for (size_t i = 0; i < self->allocated; ++i)
+/**
+ * @brief Položka s daným klíčem v indexu, případně ve starém indexu.
+ *
+ * Tabulku nemění, pro čtení tedy stačí sdílený přístup.
+ *
+ * @return Položka, nebo @c NULL pokud se klíč nenachází v tabulce.
+ */
+static inline hash_map_item_t* hash_map_find_item(hash_map_t* self, const char* key,
+                                                  size_t length, size_t hash)
+{
+    size_t idx = hash_map_find(self, key, length, hash);
+    if (self->index[idx] != NULL || self->old_index == NULL)
     {
-        self->index[i] = NULL;
+        return self->index[idx];
     }
-    
-
-    self->first = NULL;
-    self->last = NULL;
-    self->used = 0;
-}
 
-void hash_map_dtor(hash_map_t* self)
-{
-    hash_map_clear(self);
-    free(self->index);
-    free(self->dummy);
-    self->index = NULL;
-    self->allocated = 0;
-    free(self);
+    // klic jeste mohl zustat ve starem indexu
+    hash_map_t old;
+    hash_map_old_view(self, &old);
+    size_t old_idx = hash_map_find(&old, key, length, hash);
+#ifdef HASH_MAP_STATS
+    self->lookups = old.lookups;
+    self->lookup_probes = old.lookup_probes;
+#endif
+    return old.index[old_idx];
 }
 
-hash_map_state_code_t hash_map_reserve(hash_map_t* self, size_t size)
+/**
+ * @brief Nový index zadané velikosti a opětovné vložení všech položek.
+ *
+ * Položky se vkládají podle seznamu, v novém indexu tedy nejsou žádné
+ * odstraněné pozice. Velikost může být i stejná jako dosavadní, pak se index
+ * jen zbaví odstraněných pozic.
+ *
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ * @param[in] size Velikost indexu, alespoň @c used .
+ *
+ * @return @c MEMORY_ERROR v případě chyby v alokaci paměti, jinak @c OK.
+ */
+static hash_map_state_code_t hash_map_rehash(hash_map_t* self, size_t size)
 {
-    // chceme alokovat mene mista nez je vlozenych zaznamu?
-    if (size < self->used)
+    // calloc vraci vynulovany index, velke bloky bez nutnosti je prochazet
+    hash_map_item_t** new_index = (hash_map_item_t**)calloc(size, sizeof(hash_map_item_t*));
+    unsigned char* new_tags = (unsigned char*)malloc(size);
+    if (new_index == NULL || new_tags == NULL)
     {
-        return VALUE_ERROR;
+        // alokace pameti selhala
+        free(new_index);
+        free(new_tags);
+        return MEMORY_ERROR;
     }
-
-    if (size == self->allocated)
+    if (self->engine == HASH_MAP_ENGINE_GROUP)
     {
-        // jiz je alokovano
-        return OK;
+        memset(new_tags, HASH_MAP_CTRL_EMPTY, size);
     }
 
-    hash_map_item_t** new_index = (hash_map_item_t**)malloc(size*sizeof(hash_map_t*));
-    if (new_index == NULL)
-    {
-        // alokace pameti selhala
-        return MEMORY_ERROR;
-    }
-    // vycisteni indexu
-    for (size_t i = 0; i < size; ++i)
-    {
-        new_index[i] = NULL;
-    }
+    // nahrazeni stareho indexu, pozice se hledaji uz v novem indexu
+    hash_map_item_t** old_index = self->index;
+    free(self->tags);
+    self->index = new_index;
+    self->tags = new_tags;
+    self->allocated = size;
+    self->resizes++;
 
-    if (self->index != NULL)
+    if (old_index != NULL)
     {
         // prekopirovani indexu
         size_t idx;
         for (hash_map_item_t* item = self->first; item != NULL; item = item->next)
         {
-            // zmenila se velikost, potrebujeme prepocitat indexy
-            idx = hash_map_lookup(self, item->key, item->hash);
+            // zmenila se velikost, potrebujeme prepocitat indexy, klice jsou
+            // ruzne a staci prvni volne misto podle ulozeneho hase
+            if (self->engine == HASH_MAP_ENGINE_GROUP)
+            {
+                idx = hash_map_group_free_slot(self, item->hash);
+            }
+            else
+            {
+                idx = hash_map_perturb_free_slot(self, item->hash);
+            }
             new_index[idx] = item;
+            new_tags[idx] = hash_map_slot_tag(self, item->hash);
         }
         // uvolneni stareho indexu
-        free(self->index);
+        free(old_index);
     }
-    // nahrazeni stareho indexu
-    self->index = new_index;
-    self->allocated = size;
+    self->deleted = 0;
+
+    // seznam obsahuje i neprevedene polozky, postupne zvetsovani je hotovo
+    free(self->old_index);
+    free(self->old_tags);
+    self->old_index = NULL;
+    self->old_tags = NULL;
+    self->old_allocated = 0;
 
     return OK; 
 }
 
-size_t hash_map_size(hash_map_t* self) 
+/**
+ * @brief Převedení položky z pozice starého indexu do indexu.
+ *
+ * Převedená pozice dostane @c dummy, aby hledání ostatních klíčů ve starém
+ * indexu pokračovalo přes ni.
+ *
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ * @param[in] idx  Pozice ve starém indexu.
+ */
+static void hash_map_migrate_slot(hash_map_t* self, size_t idx)
 {
-    return self->used;
+    hash_map_item_t* item = self->old_index[idx];
+    if (item == NULL || item == self->dummy)
+    {
+        return;
+    }
+
+    size_t slot;
+    if (self->engine == HASH_MAP_ENGINE_GROUP)
+    {
+        slot = hash_map_group_free_slot(self, item->hash);
+    }
+    else
+    {
+        slot = hash_map_perturb_free_slot(self, item->hash);
+    }
+    if (self->index[slot] == self->dummy)
+    {
+        self->deleted--;
+    }
+    self->index[slot] = item;
+    self->tags[slot] = hash_map_slot_tag(self, item->hash);
+
+    self->old_index[idx] = self->dummy;
+    if (self->engine == HASH_MAP_ENGINE_GROUP)
+    {
+        self->old_tags[idx] = HASH_MAP_CTRL_DELETED;
+    }
 }
 
-size_t hash_map_capacity(hash_map_t* self)
+/**
+ * @brief Převedení dalších pozic starého indexu.
+ *
+ * Po převedení poslední pozice se starý index uvolní.
+ *
+ * @param[in] self  Ukazatel na strukturu hašovací tabulky.
+ * @param[in] count Nejvyšší počet převedených pozic.
+ */
+static void hash_map_migrate(hash_map_t* self, size_t count)
 {
-    return self->allocated;
+    size_t end = self->old_allocated - self->migrated < count ?
+        self->old_allocated : self->migrated + count;
+    for (; self->migrated < end; self->migrated++)
+    {
+        hash_map_migrate_slot(self, self->migrated);
+    }
+
+    if (self->migrated == self->old_allocated)
+    {
+        free(self->old_index);
+        free(self->old_tags);
+        self->old_index = NULL;
+        self->old_tags = NULL;
+        self->old_allocated = 0;
+    }
 }
 
-bool hash_map_contains(hash_map_t* self, const char* key)
+/**
+ * @brief Krok postupného zvětšování před změnou klíče.
+ *
+ * Klíč ležící ve starém indexu se převede hned, změna se pak týká jen
+ * indexu. Potom se převede dalších @c HASH_MAP_MIGRATE_STEP pozic.
+ *
+ * @param[in] self   Ukazatel na strukturu hašovací tabulky.
+ * @param[in] key    Klíč.
+ * @param[in] length Délka klíče.
+ * @param[in] hash   Haš klíče.
+ */
+static void hash_map_migrate_key(hash_map_t* self, const char* key, size_t length, size_t hash)
 {
-    size_t hash = hash_function(key); 
-    size_t idx = hash_map_lookup(self, key, hash);
-    return self->index[idx] != NULL;
+    if (self->old_index == NULL)
+    {
+        return;
+    }
+
+    hash_map_t old;
+    hash_map_old_view(self, &old);
+    size_t idx = hash_map_find(&old, key, length, hash);
+#ifdef HASH_MAP_STATS
+    self->lookups = old.lookups;
+    self->lookup_probes = old.lookup_probes;
+#endif
+    if (old.index[idx] != NULL)
+    {
+        hash_map_migrate_slot(self, idx);
+    }
+    hash_map_migrate(self, HASH_MAP_MIGRATE_STEP);
 }
 
-hash_map_state_code_t hash_map_put(hash_map_t* self, const char* key, int value)
+/**
+ * @brief Začátek postupného zvětšování indexu.
+ *
+ * Dosavadní index se stane starým indexem a položky se z něj převádí při
+ * dalších změnách tabulky. Nedokončené převádění se nejprve dokončí.
+ *
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ * @param[in] size Velikost nového indexu.
+ *
+ * @return @c MEMORY_ERROR v případě chyby v alokaci paměti, jinak @c OK.
+ */
+static hash_map_state_code_t hash_map_grow_incremental(hash_map_t* self, size_t size)
+{
+    if (self->old_index != NULL)
+    {
+        hash_map_migrate(self, self->old_allocated);
+    }
+
+    hash_map_item_t** new_index = (hash_map_item_t**)calloc(size, sizeof(hash_map_item_t*));
+    unsigned char* new_tags = (unsigned char*)malloc(size);
+    if (new_index == NULL || new_tags == NULL)
+    {
+        // alokace pameti selhala
+        free(new_index);
+        free(new_tags);
+        return MEMORY_ERROR;
+    }
+    if (self->engine == HASH_MAP_ENGINE_GROUP)
+    {
+        memset(new_tags, HASH_MAP_CTRL_EMPTY, size);
+    }
+
+    // odstranene pozice zustavaji jen ve starem indexu
+    self->old_index = self->index;
+    self->old_tags = self->tags;
+    self->old_allocated = self->allocated;
+    self->migrated = 0;
+    self->index = new_index;
+    self->tags = new_tags;
+    self->allocated = size;
+    self->deleted = 0;
+    self->resizes++;
+
+    return OK;
+}
+
+/**
+ * @brief Mez zaplnění indexu podle způsobu prohledávání tabulky.
+ */
+static inline double hash_map_threshold(hash_map_engine_t engine)
+{
+    return engine == HASH_MAP_ENGINE_GROUP ?
+        HASH_MAP_GROUP_THRESHOLD : HASH_MAP_REALLOCATION_THRESHOLD;
+}
+
+/**
+ * @brief Velikost indexu, do kterého se vejde zadaný počet klíčů bez realokace.
+ *
+ * Velikost roste zdvojováním od @c HASH_MAP_INIT_SIZE stejně jako při vkládání.
+ *
+ * @param[in] engine   Způsob prohledávání indexu.
+ * @param[in] capacity Počet klíčů.
+ *
+ * @return Velikost indexu.
+ */
+static size_t hash_map_index_size(hash_map_engine_t engine, size_t capacity)
 {
-    // je potreba realokovat misto?
-    if (((float)self->used / (float)self->allocated) >= HASH_MAP_REALLOCATION_THRESHOLD)
+    size_t size = HASH_MAP_INIT_SIZE;
+    while ((double)capacity > (double)size * hash_map_threshold(engine))
     {
-        hash_map_reserve(self, self->allocated<<1);
+        size <<= 1;
     }
+    return size;
+}
 
-    size_t hash = hash_function(key);
-    size_t idx = hash_map_lookup_handle(self, key, hash, false);
+/**
+ * @brief Haše dávky klíčů a přednačtení jejich pozic v indexu a položek.
+ *
+ * Nejprve se spočítají všechny haše a přednačtou se první pozice indexu (u
+ * skupinového prohledávání i otisky skupiny), potom se přednačtou položky na
+ * těchto pozicích. Výpadky cache celé dávky se tak překrývají a následné
+ * vyhledávání je najde v cache.
+ *
+ * @param[in]  self    Ukazatel na strukturu hašovací tabulky.
+ * @param[in]  keys    Klíče, nejvýše @c HASH_MAP_BATCH_SIZE.
+ * @param[in]  count   Počet klíčů.
+ * @param[out] lengths Délky klíčů.
+ * @param[out] hashes  Haše klíčů.
+ */
+static void hash_map_prefetch_batch(hash_map_t* self, const char* const* keys, size_t count,
+                                    size_t* lengths, size_t* hashes)
+{
+    size_t slots[HASH_MAP_BATCH_SIZE];
+    size_t groups = self->allocated / HASH_MAP_GROUP_WIDTH;
 
-    // prazdne misto v indexu nebo se jedna o dummy objekt
-    // Vizte hash_map_lookup_handle
-    if (self->index[idx] == NULL || self->index[idx] == self->dummy) 
+    for (size_t i = 0; i < count; i++)
     {
-        self->index[idx] = (hash_map_item_t*)malloc(sizeof(hash_map_item_t));
-        if (self->index[idx] == NULL)
+        lengths[i] = strlen(keys[i]);
+        hashes[i] = hash_map_hash_key(self, keys[i], lengths[i]);
+        if (self->engine == HASH_MAP_ENGINE_GROUP)
         {
-            // alokace pameti selhala
-            return MEMORY_ERROR;
+            slots[i] = hashes[i] % groups * HASH_MAP_GROUP_WIDTH;
+            HASH_MAP_PREFETCH(self->tags + slots[i]);
         }
-
-        self->index[idx]->key = (char*)malloc((strlen(key)+1)*sizeof(char));
-        if (self->index[idx]->key == NULL)
+        else
         {
-            // alokace pameti selhala
-            free(self->index[idx]);
-            self->index[idx] = NULL;
-            return MEMORY_ERROR;
+            slots[i] = hashes[i] % self->allocated;
         }
-        strcpy(self->index[idx]->key, key);
-        self->index[idx]->hash = hash;
-        self->index[idx]->value = value;
-        self->index[idx]->next = NULL;
-        self->index[idx]->prev = NULL;
-        self->used++;
-        // je seznam zaznamu prazdny?
-        if (self->last == NULL)
+        HASH_MAP_PREFETCH(self->index + slots[i]);
+    }
+
+    // u skupiny se prednacita polozka na prvni pozici se shodnym otiskem
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t idx = slots[i];
+        if (self->engine == HASH_MAP_ENGINE_GROUP)
         {
-            self->first = self->last = self->index[idx];
+            unsigned mask = hash_map_group_match(self->tags + idx, hash_map_slot_tag(self, hashes[i]));
+            if (mask == 0)
+            {
+                continue;
+            }
+            idx += hash_map_lowest_bit(mask);
         }
-        else
+        hash_map_item_t* item = self->index[idx];
+        if (item != NULL && item != self->dummy)
         {
-            self->last->next = self->index[idx];
-            self->index[idx]->prev = self->last;
-            self->last = self->index[idx];
+            HASH_MAP_PREFETCH(item);
         }
-        return OK;
     }
-    else 
+}
+
+/**
+ * @brief Inicializace hašovací tabulky se zvoleným způsobem prohledávání.
+ *
+ * @see hash_map_init
+ */
+static hash_map_state_code_t hash_map_init_engine(hash_map_t* self, size_t size,
+                                                  hash_map_engine_t engine)
+{
+    self->dummy = (hash_map_item_t*)malloc(sizeof(hash_map_item_t));
+    self->first = self->last = NULL;
+    self->used = 0;
+    self->deleted = 0;
+    self->allocated = 0;
+    self->index = NULL;
+    self->tags = NULL;
+    self->hash_function = hash_map_hash_wy;
+    self->seed = 0;
+    self->arena = NULL;
+    self->engine = engine;
+    self->shrink = false;
+    self->value_size = 0;
+    self->incremental = false;
+    self->old_index = NULL;
+    self->old_tags = NULL;
+    self->old_allocated = 0;
+    self->migrated = 0;
+    self->key_bytes = 0;
+    self->resizes = 0;
+    self->lookups = 0;
+    self->lookup_probes = 0;
+    
+    if (hash_map_reserve(self, size) == MEMORY_ERROR)
     {
-        self->index[idx]->value = value;
-        return KEY_ALREADY_EXISTS;
+        free(self->dummy);
+        return MEMORY_ERROR;
     }
+    // prvni index se mezi prestavby nepocita
+    self->resizes = 0;
+
+    return OK;
 }
 
-hash_map_state_code_t hash_map_get(hash_map_t* self, const char* key, int* dst)
+/**
+ * @brief Inicializace hašovací tabulky.
+ * 
+ * Metoda alokuje a inicializuje položky struktury hašovací tabulky.
+ * 
+ * @param self[in] Ukazatel na neinicializovanou hašovací tabulku
+ * @param size[in] Počet prvků v tabulce.
+ * 
+ * @return @c MEMORY_ERROR v případě chyby v alokaci paměti, jinak @c OK.
+ */
+hash_map_state_code_t hash_map_init(hash_map_t* self, size_t size)
 {
-    size_t hash = hash_function(key);
-    size_t idx = hash_map_lookup(self, key, hash);
+    return hash_map_init_engine(self, size, HASH_MAP_ENGINE_PERTURB);
+}
 
-    if (self->index[idx] == NULL)
+/*******************************************************************************
+ * Definice veřejných metod.
+ ******************************************************************************/
+
+hash_map_t* hash_map_ctor()
+{
+    hash_map_t* map = (hash_map_t*)malloc(sizeof(hash_map_t));
+    if (map != NULL && hash_map_init(map, HASH_MAP_INIT_SIZE) == MEMORY_ERROR) 
     {
-        // klic neni asociovan se zadnym zaznamem
-        return KEY_ERROR;
+        free(map);
+        map = NULL;
     }
-    
-    *dst = self->index[idx]->value;
+    return map;
+}
 
-    return OK;
+hash_map_t* hash_map_ctor_with_config(const hash_map_config_t* config)
+{
+    hash_map_engine_t engine = config != NULL ? config->engine : HASH_MAP_ENGINE_PERTURB;
+    size_t size = hash_map_index_size(engine, config != NULL ? config->capacity : 0);
+    hash_map_t* map = (hash_map_t*)malloc(sizeof(hash_map_t));
+    if (map != NULL && hash_map_init_engine(map, size, engine) == MEMORY_ERROR)
+    {
+        free(map);
+        map = NULL;
+    }
+    if (map != NULL && config != NULL)
+    {
+        if (config->hash_function != NULL)
+        {
+            map->hash_function = config->hash_function;
+        }
+        map->seed = config->seed;
+        map->shrink = config->shrink;
+        map->value_size = config->value_size;
+        map->incremental = config->incremental;
+        if (config->arena)
+        {
+            map->arena = (hash_map_arena_t*)calloc(1, sizeof(hash_map_arena_t));
+            if (map->arena == NULL)
+            {
+                hash_map_dtor(map);
+                map = NULL;
+            }
+        }
+    }
+    return map;
 }
 
-hash_map_state_code_t hash_map_remove(hash_map_t* self, const char* key)
+hash_map_t* hash_map_ctor_with_capacity(size_t capacity)
 {
-    int dst;
-    return hash_map_pop(self, key, &dst);
+    hash_map_config_t config = {};
+    config.capacity = capacity;
+    return hash_map_ctor_with_config(&config);
 }
 
-hash_map_state_code_t hash_map_pop(hash_map_t* self, const char* key, int* dst)
+hash_map_t* hash_map_ctor_with_engine(hash_map_engine_t engine)
 {
-    size_t hash = hash_function(key);
-    size_t idx = hash_map_lookup(self, key, hash);
+    hash_map_config_t config = {};
+    config.engine = engine;
+    return hash_map_ctor_with_config(&config);
+}
 
-    if (self->index[idx] == NULL)
+void hash_map_clear(hash_map_t* self)
+{
+    if (self->arena != NULL)
     {
-        // klic neni asociovan se zadnym zaznamem
-        return KEY_ERROR;
+        // polozky jsou v blocich areny, neni treba je prochazet
+        hash_map_arena_release(self->arena, true);
     }
-    else 
+    else
+    {
+        hash_map_item_t* item = self->first;
+        hash_map_item_t* curr_item;
+        while (item != NULL)
+        {
+            curr_item = item;
+            item = item->next;
+            free(curr_item);
+        }
+    }
+
+    memset(self->index, 0, self->allocated * sizeof(hash_map_item_t*));
+    if (self->engine == HASH_MAP_ENGINE_GROUP)
+    {
+        memset(self->tags, HASH_MAP_CTRL_EMPTY, self->allocated);
+    }
+    free(self->old_index);
+    free(self->old_tags);
+    self->old_index = NULL;
+    self->old_tags = NULL;
+    self->old_allocated = 0;
+
+
+    self->first = NULL;
+    self->last = NULL;
+    self->used = 0;
+    self->key_bytes = 0;
+    self->deleted = 0;
+}
+
+void hash_map_dtor(hash_map_t* self)
+{
+    hash_map_clear(self);
+    if (self->arena != NULL)
+    {
+        hash_map_arena_release(self->arena, false);
+        free(self->arena);
+    }
+    free(self->index);
+    free(self->tags);
+    free(self->dummy);
+    self->index = NULL;
+    self->tags = NULL;
+    self->allocated = 0;
+    free(self);
+}
+
+hash_map_state_code_t hash_map_reserve(hash_map_t* self, size_t size)
+{
+    // chceme alokovat mene mista nez je vlozenych zaznamu?
+    if (size < self->used)
+    {
+        return VALUE_ERROR;
+    }
+
+    if (self->engine == HASH_MAP_ENGINE_GROUP)
     {
-        // jedna se o prvni zaznam v seznamu?
-        if (self->index[idx]->prev == NULL)
+        // index se sklada z celych skupin a vzdy ma alespon jedno volne misto
+        size = (size + HASH_MAP_GROUP_WIDTH - 1) / HASH_MAP_GROUP_WIDTH * HASH_MAP_GROUP_WIDTH;
+        if (size == self->used)
         {
-            self->first = self->index[idx]->next;
+            size += HASH_MAP_GROUP_WIDTH;
         }
-        else 
+    }
+
+    if (size == self->allocated)
+    {
+        // jiz je alokovano
+        return OK;
+    }
+
+    return hash_map_rehash(self, size);
+}
+
+size_t hash_map_size(hash_map_t* self) 
+{
+    return self->used;
+}
+
+size_t hash_map_capacity(hash_map_t* self)
+{
+    return self->allocated;
+}
+
+size_t hash_map_hash_key(hash_map_t* self, const char* key, size_t length)
+{
+    return self->hash_function(key, length, self->seed);
+}
+
+bool hash_map_contains(hash_map_t* self, const char* key)
+{
+    size_t length = strlen(key);
+    return hash_map_contains_hashed(self, key, length, hash_map_hash_key(self, key, length));
+}
+
+bool hash_map_contains_hashed(hash_map_t* self, const char* key, size_t length, size_t hash)
+{
+    return hash_map_find_item(self, key, length, hash) != NULL;
+}
+
+/**
+ * @brief Vyhledání klíče a případné vložení nové položky.
+ *
+ * @param[in]  self     Ukazatel na strukturu hašovací tabulky.
+ * @param[in]  key      Klíč.
+ * @param[in]  length   Délka klíče, nejvýše @c UINT_MAX.
+ * @param[in]  hash     Haš klíče.
+ * @param[out] inserted @c true pokud byla položka nově vložena.
+ *
+ * @return Nalezená nebo nová položka (s neinicializovanou hodnotou), nebo
+ *         @c NULL při chybě alokace.
+ */
+static hash_map_item_t* hash_map_insert_hashed(hash_map_t* self, const char* key, size_t length,
+                                               size_t hash, bool* inserted)
+{
+    // je potreba realokovat misto? odstranene pozice prodluzuji hledani stejne
+    // jako obsazene
+    double threshold = hash_map_threshold(self->engine);
+    if (((float)(self->used + self->deleted) / (float)self->allocated) >= threshold)
+    {
+        if ((float)self->used / (float)self->allocated <= threshold / 2)
         {
-            self->index[idx]->prev->next = self->index[idx]->next;
+            // vetsina pozic je odstranenych, staci index prestavet
+            hash_map_rehash(self, self->allocated);
         }
-        // jedna se o posledni zaznam v seznamu?
-        if (self->index[idx]->next == NULL)
+        else if (self->incremental)
         {
-            self->last = self->index[idx]->prev;
+            hash_map_grow_incremental(self, self->allocated<<1);
         }
-        else 
+        else
         {
-            self->index[idx]->next->prev = self->index[idx]->prev;
+            hash_map_reserve(self, self->allocated<<1);
         }
-        // uloz hodnotu
-        *dst = self->index[idx]->value;
-        // smaz zaznam
-        free(self->index[idx]->key);
-        free(self->index[idx]);
-        // Nahrazeni zaznamu za dummy objekt.
-        // V pripade kolize, odstraneni prvne vlozeneho zaznamu s kolizi,
-        // a nastaveni daneho mista na NULL, algoritmus by nemel informaci, 
-        // zda ke kolizi doslo.
-        self->index[idx] = self->dummy;
     }
+    hash_map_migrate_key(self, key, length, hash);
 
+    size_t idx = hash_map_find(self, key, length, hash);
+
+    // klic v tabulce neni
+    if (self->index[idx] == NULL) 
+    {
+        if (self->deleted != 0)
+        {
+            // pred nalezenym volnym mistem muze lezet odstranena pozice
+            // Vizte hash_map_lookup_handle
+            if (self->engine == HASH_MAP_ENGINE_GROUP)
+            {
+                idx = hash_map_group_free_slot(self, hash);
+            }
+            else
+            {
+                idx = hash_map_lookup_handle(self, key, length, hash, false);
+            }
+            if (self->index[idx] == self->dummy)
+            {
+                self->deleted--;
+            }
+        }
+        // polozka i klic v jedine alokaci, klic lezi hned za polozkou
+        hash_map_item_t* item = hash_map_item_alloc(self, length);
+        if (item == NULL)
+        {
+            // alokace pameti selhala
+            return NULL;
+        }
+        self->index[idx] = item;
+
+        self->tags[idx] = hash_map_slot_tag(self, hash);
+        self->index[idx]->key = (char*)item + hash_map_key_offset(self);
+        memcpy(self->index[idx]->key, key, length);
+        self->index[idx]->key[length] = '\0';
+        self->index[idx]->length = (unsigned int)length;
+        self->index[idx]->hash = hash;
+        self->index[idx]->next = NULL;
+        self->index[idx]->prev = NULL;
+        self->used++;
+        self->key_bytes += length + 1;
+        // je seznam zaznamu prazdny?
+        if (self->last == NULL)
+        {
+            self->first = self->last = self->index[idx];
+        }
+        else
+        {
+            self->last->next = self->index[idx];
+            self->index[idx]->prev = self->last;
+            self->last = self->index[idx];
+        }
+        *inserted = true;
+        return item;
+    }
+
+    *inserted = false;
+    return self->index[idx];
+}
+
+hash_map_state_code_t hash_map_put_hashed(hash_map_t* self, const char* key, size_t length,
+                                          size_t hash, int value)
+{
+    // delka klice se uklada do polozky jako unsigned int
+    if (length > UINT_MAX)
+    {
+        return VALUE_ERROR;
+    }
+
+    bool inserted;
+    hash_map_item_t* item = hash_map_insert_hashed(self, key, length, hash, &inserted);
+    if (item == NULL)
+    {
+        return MEMORY_ERROR;
+    }
+    item->value = value;
+    return inserted ? OK : KEY_ALREADY_EXISTS;
+}
+
+void* hash_map_emplace_hashed(hash_map_t* self, const char* key, size_t length, size_t hash,
+                              bool* inserted)
+{
+    if (length > UINT_MAX)
+    {
+        return NULL;
+    }
+
+    hash_map_item_t* item = hash_map_insert_hashed(self, key, length, hash, inserted);
+    return item != NULL ? hash_map_item_value(item) : NULL;
+}
+
+void* hash_map_find_value_hashed(hash_map_t* self, const char* key, size_t length, size_t hash)
+{
+    hash_map_item_t* item = hash_map_find_item(self, key, length, hash);
+    return item != NULL ? hash_map_item_value(item) : NULL;
+}
+
+void* hash_map_item_value(hash_map_item_t* item)
+{
+    return (char*)item + HASH_MAP_VALUE_OFFSET;
+}
+
+hash_map_state_code_t hash_map_put(hash_map_t* self, const char* key, int value)
+{
+    size_t length = strlen(key);
+    return hash_map_put_hashed(self, key, length, hash_map_hash_key(self, key, length), value);
+}
+
+hash_map_state_code_t hash_map_put_many(hash_map_t* self, const char* const* keys,
+                                        const int* values, size_t count,
+                                        hash_map_state_code_t* results)
+{
+    size_t lengths[HASH_MAP_BATCH_SIZE];
+    size_t hashes[HASH_MAP_BATCH_SIZE];
+
+    for (size_t begin = 0; begin < count; begin += HASH_MAP_BATCH_SIZE)
+    {
+        size_t batch = count - begin < HASH_MAP_BATCH_SIZE ? count - begin : HASH_MAP_BATCH_SIZE;
+        hash_map_prefetch_batch(self, keys + begin, batch, lengths, hashes);
+        for (size_t i = 0; i < batch; i++)
+        {
+            hash_map_state_code_t code = hash_map_put_hashed(self, keys[begin + i], lengths[i],
+                                                             hashes[i], values[begin + i]);
+            if (code == MEMORY_ERROR)
+            {
+                // zbyle klice se nevlozi
+                return MEMORY_ERROR;
+            }
+            if (results != NULL)
+            {
+                results[begin + i] = code;
+            }
+        }
+    }
+    return OK;
+}
+
+hash_map_state_code_t hash_map_get(hash_map_t* self, const char* key, int* dst)
+{
+    size_t length = strlen(key);
+    return hash_map_get_hashed(self, key, length, hash_map_hash_key(self, key, length), dst);
+}
+
+hash_map_state_code_t hash_map_get_hashed(hash_map_t* self, const char* key, size_t length,
+                                          size_t hash, int* dst)
+{
+    hash_map_item_t* item = hash_map_find_item(self, key, length, hash);
+
+    if (item == NULL)
+    {
+        // klic neni asociovan se zadnym zaznamem
+        return KEY_ERROR;
+    }
+    
+    *dst = item->value;
+
+    return OK;
+}
+
+size_t hash_map_get_many(hash_map_t* self, const char* const* keys, size_t count,
+                         int* values, hash_map_state_code_t* results)
+{
+    size_t lengths[HASH_MAP_BATCH_SIZE];
+    size_t hashes[HASH_MAP_BATCH_SIZE];
+    size_t found = 0;
+
+    for (size_t begin = 0; begin < count; begin += HASH_MAP_BATCH_SIZE)
+    {
+        size_t batch = count - begin < HASH_MAP_BATCH_SIZE ? count - begin : HASH_MAP_BATCH_SIZE;
+        hash_map_prefetch_batch(self, keys + begin, batch, lengths, hashes);
+        for (size_t i = 0; i < batch; i++)
+        {
+            hash_map_item_t* item = hash_map_find_item(self, keys[begin + i], lengths[i], hashes[i]);
+            hash_map_state_code_t code = KEY_ERROR;
+            if (item != NULL)
+            {
+                values[begin + i] = item->value;
+                code = OK;
+                found++;
+            }
+            if (results != NULL)
+            {
+                results[begin + i] = code;
+            }
+        }
+    }
+    return found;
+}
+
+size_t hash_map_contains_many(hash_map_t* self, const char* const* keys, size_t count,
+                              bool* found)
+{
+    size_t lengths[HASH_MAP_BATCH_SIZE];
+    size_t hashes[HASH_MAP_BATCH_SIZE];
+    size_t found_count = 0;
+
+    for (size_t begin = 0; begin < count; begin += HASH_MAP_BATCH_SIZE)
+    {
+        size_t batch = count - begin < HASH_MAP_BATCH_SIZE ? count - begin : HASH_MAP_BATCH_SIZE;
+        hash_map_prefetch_batch(self, keys + begin, batch, lengths, hashes);
+        for (size_t i = 0; i < batch; i++)
+        {
+            bool contains = hash_map_contains_hashed(self, keys[begin + i], lengths[i], hashes[i]);
+            found_count += contains;
+            if (found != NULL)
+            {
+                found[begin + i] = contains;
+            }
+        }
+    }
+    return found_count;
+}
+
+hash_map_state_code_t hash_map_remove(hash_map_t* self, const char* key)
+{
+    int dst;
+    return hash_map_pop(self, key, &dst);
+}
+
+hash_map_state_code_t hash_map_pop(hash_map_t* self, const char* key, int* dst)
+{
+    size_t length = strlen(key);
+    return hash_map_pop_hashed(self, key, length, hash_map_hash_key(self, key, length), dst);
+}
+
+/**
+ * @brief Odstranění položky na dané pozici indexu.
+ *
+ * Položka se odpojí ze seznamu a uvolní, pozice se označí jako odstraněná a
+ * případně se zmenší index.
+ *
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ * @param[in] idx  Pozice položky v indexu.
+ */
+static void hash_map_remove_at(hash_map_t* self, size_t idx)
+{
+    // jedna se o prvni zaznam v seznamu?
+    if (self->index[idx]->prev == NULL)
+    {
+        self->first = self->index[idx]->next;
+    }
+    else 
+    {
+        self->index[idx]->prev->next = self->index[idx]->next;
+    }
+    // jedna se o posledni zaznam v seznamu?
+    if (self->index[idx]->next == NULL)
+    {
+        self->last = self->index[idx]->prev;
+    }
+    else 
+    {
+        self->index[idx]->next->prev = self->index[idx]->prev;
+    }
+    // smaz zaznam
+    self->key_bytes -= self->index[idx]->length + 1;
+    hash_map_item_free(self, self->index[idx]);
+    // Nahrazeni zaznamu za dummy objekt.
+    // V pripade kolize, odstraneni prvne vlozeneho zaznamu s kolizi,
+    // a nastaveni daneho mista na NULL, algoritmus by nemel informaci, 
+    // zda ke kolizi doslo.
+    self->index[idx] = self->dummy;
+    self->used--;
+    self->deleted++;
+    if (self->engine == HASH_MAP_ENGINE_GROUP)
+    {
+        // skupinou s volnym mistem zadne hledani neprochazi dal,
+        // pozici lze rovnou uvolnit
+        size_t group = idx / HASH_MAP_GROUP_WIDTH * HASH_MAP_GROUP_WIDTH;
+        if (hash_map_group_match(self->tags + group, HASH_MAP_CTRL_EMPTY) != 0)
+        {
+            self->index[idx] = NULL;
+            self->tags[idx] = HASH_MAP_CTRL_EMPTY;
+            self->deleted--;
+        }
+        else
+        {
+            self->tags[idx] = HASH_MAP_CTRL_DELETED;
+        }
+    }
+
+    // zmenseni ridkeho indexu, po zmenseni je zaplnen nejvyse do poloviny meze
+    size_t minimum = self->engine == HASH_MAP_ENGINE_GROUP ?
+        HASH_MAP_GROUP_WIDTH : HASH_MAP_INIT_SIZE;
+    if (self->shrink && self->allocated / 2 >= minimum &&
+        (float)self->used / (float)self->allocated < hash_map_threshold(self->engine) / 4)
+    {
+        hash_map_reserve(self, self->allocated / 2);
+    }
+}
+
+hash_map_state_code_t hash_map_pop_hashed(hash_map_t* self, const char* key, size_t length,
+                                          size_t hash, int* dst)
+{
+    hash_map_migrate_key(self, key, length, hash);
+    size_t idx = hash_map_find(self, key, length, hash);
+
+    if (self->index[idx] == NULL)
+    {
+        // klic neni asociovan se zadnym zaznamem
+        return KEY_ERROR;
+    }
+
+    // uloz hodnotu
+    *dst = self->index[idx]->value;
+    hash_map_remove_at(self, idx);
+
+    return OK;
+}
+
+hash_map_state_code_t hash_map_pop_value_hashed(hash_map_t* self, const char* key, size_t length,
+                                                size_t hash, hash_map_value_consumer_t consume,
+                                                void* context)
+{
+    hash_map_migrate_key(self, key, length, hash);
+    size_t idx = hash_map_find(self, key, length, hash);
+
+    if (self->index[idx] == NULL)
+    {
+        // klic neni asociovan se zadnym zaznamem
+        return KEY_ERROR;
+    }
+
+    // hodnota se preda pred uvolnenim polozky
+    if (consume != NULL)
+    {
+        consume(hash_map_item_value(self->index[idx]), context);
+    }
+    hash_map_remove_at(self, idx);
+
+    return OK;
+}
+
+hash_map_iter_t hash_map_iter_begin(hash_map_t* self)
+{
+    hash_map_iter_t iter;
+    iter.item = self->first;
+    return iter;
+}
+
+bool hash_map_iter_next(hash_map_iter_t* iter, const char** key, size_t* length, int* value)
+{
+    hash_map_item_t* item = iter->item;
+    if (item == NULL)
+    {
+        return false;
+    }
+
+    // posun pred vracenim, polozku lze hned odstranit
+    iter->item = item->next;
+    if (key != NULL)
+    {
+        *key = item->key;
+    }
+    if (length != NULL)
+    {
+        *length = item->length;
+    }
+    if (value != NULL)
+    {
+        *value = item->value;
+    }
+    return true;
+}
+
+hash_map_state_code_t hash_map_compact(hash_map_t* self)
+{
+    // hodnoty v polozkach nemusi snest presun po bajtech (napr. std::string)
+    if (self->value_size != 0)
+    {
+        return VALUE_ERROR;
+    }
+
+    // velikost vsech polozek v poradi seznamu
+    size_t total = 0;
+    for (hash_map_item_t* item = self->first; item != NULL; item = item->next)
+    {
+        total += hash_map_arena_item_size(self, item->length);
+    }
+
+    hash_map_arena_t* arena = (hash_map_arena_t*)calloc(1, sizeof(hash_map_arena_t));
+    hash_map_arena_chunk_t* chunk = (hash_map_arena_chunk_t*)malloc(HASH_MAP_ARENA_HEADER + total);
+    if (arena == NULL || chunk == NULL)
+    {
+        // alokace pameti selhala
+        free(arena);
+        free(chunk);
+        return MEMORY_ERROR;
+    }
+    chunk->next = NULL;
+    chunk->size = total;
+    arena->chunks = chunk;
+    arena->cursor = (char*)chunk + HASH_MAP_ARENA_HEADER;
+
+    // pozice se hledaji jen v indexu
+    if (self->old_index != NULL)
+    {
+        hash_map_migrate(self, self->old_allocated);
+    }
+
+    hash_map_item_t* prev = NULL;
+    hash_map_item_t* item = self->first;
+    while (item != NULL)
+    {
+        size_t size = hash_map_arena_item_size(self, item->length);
+        hash_map_item_t* copy = (hash_map_item_t*)arena->cursor;
+        arena->cursor += size;
+        memcpy(copy, item, hash_map_key_offset(self) + item->length + 1);
+        copy->key = (char*)copy + hash_map_key_offset(self);
+
+        // puvodni polozka je stale platna, jeji pozice se najde podle klice
+        size_t idx = hash_map_find(self, item->key, item->length, item->hash);
+        self->index[idx] = copy;
+
+        copy->prev = prev;
+        if (prev == NULL)
+        {
+            self->first = copy;
+        }
+        else
+        {
+            prev->next = copy;
+        }
+        prev = copy;
+
+        hash_map_item_t* next = item->next;
+        if (self->arena == NULL)
+        {
+            free(item);
+        }
+        item = next;
+    }
+    self->last = prev;
+
+    // puvodni arena se uvolni cela
+    if (self->arena != NULL)
+    {
+        hash_map_arena_release(self->arena, false);
+        free(self->arena);
+    }
+    self->arena = arena;
+
+    return OK;
+}
+
+/**
+ * @brief Délka hledání položky na dané pozici indexu.
+ *
+ * Projde posloupnost pozic haše položky až k pozici @p idx , položky se
+ * nečtou kromě uloženého haše.
+ *
+ * @param[in] self Ukazatel na strukturu hašovací tabulky (nebo pohled na
+ *                 starý index).
+ * @param[in] idx  Pozice obsazená položkou.
+ *
+ * @return Počet prohledaných pozic, u @c HASH_MAP_ENGINE_GROUP skupin.
+ */
+static size_t hash_map_probe_length(const hash_map_t* self, size_t idx)
+{
+    size_t hash = self->index[idx]->hash;
+    if (self->engine == HASH_MAP_ENGINE_GROUP)
+    {
+        size_t groups = self->allocated / HASH_MAP_GROUP_WIDTH;
+        return (idx / HASH_MAP_GROUP_WIDTH + groups - hash % groups) % groups + 1;
+    }
+
+    size_t slot = hash % self->allocated;
+    size_t perturb = hash;
+    size_t length = 1;
+    while (slot != idx)
+    {
+        slot = ((slot << 2) + slot + perturb + 1) % self->allocated;
+        perturb >>= HASH_MAP_PERTURB_SHIFT;
+        length++;
+    }
+    return length;
+}
+
+void hash_map_stats(hash_map_t* self, hash_map_stats_t* stats, bool scan)
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->size = self->used;
+    stats->capacity = self->allocated;
+    stats->tombstones = self->deleted;
+    stats->load_factor = (double)self->used / (double)self->allocated;
+    stats->fill_factor = (double)(self->used + self->deleted) / (double)self->allocated;
+    stats->index_bytes = (self->allocated + self->old_allocated) * (sizeof(hash_map_item_t*) + 1);
+    stats->item_bytes = self->used * hash_map_key_offset(self);
+    stats->key_bytes = self->key_bytes;
+    stats->resizes = self->resizes;
+    stats->lookups = self->lookups;
+    stats->lookup_probes = self->lookup_probes;
+
+    stats->total_bytes = sizeof(hash_map_t) + sizeof(hash_map_item_t) + stats->index_bytes;
+    if (self->arena != NULL)
+    {
+        // polozky a klice lezi v blocich areny
+        for (hash_map_arena_chunk_t* chunk = self->arena->chunks; chunk != NULL; chunk = chunk->next)
+        {
+            stats->arena_bytes += HASH_MAP_ARENA_HEADER + chunk->size;
+        }
+        stats->total_bytes += sizeof(hash_map_arena_t) + stats->arena_bytes;
+    }
+    else
+    {
+        stats->total_bytes += stats->item_bytes + stats->key_bytes;
+    }
+
+    if (!scan || self->used == 0)
+    {
+        return;
+    }
+
+    // pruchod indexem i starym indexem, pokud se jeste prevadi
+    hash_map_t old;
+    hash_map_old_view(self, &old);
+    const hash_map_t* views[2] = {self, &old};
+    size_t total = 0;
+    for (size_t view = 0; view < (self->old_index != NULL ? 2u : 1u); view++)
+    {
+        for (size_t idx = 0; idx < views[view]->allocated; idx++)
+        {
+            hash_map_item_t* item = views[view]->index[idx];
+            if (item == NULL || item == self->dummy)
+            {
+                continue;
+            }
+            size_t length = hash_map_probe_length(views[view], idx);
+            total += length;
+            if (length > stats->probe_max)
+            {
+                stats->probe_max = length;
+            }
+        }
+    }
+    stats->probe_average = (double)total / (double)self->used;
+}
+
+/** Označení a verze formátu souboru z @c hash_map_save. */
+static const char HASH_MAP_FILE_MAGIC[8] = {'H', 'M', 'A', 'P', 'v', '1', '\0', '\0'};
+
+/** Klíč kontrolního haše, kterým se ověří hašovací funkce souboru. */
+static const char HASH_MAP_FILE_CHECK_KEY[] = "hash_map";
+
+/**
+ * @brief Hlavička souboru z @c hash_map_save, posuny jsou od začátku souboru.
+ */
+typedef struct hash_map_file_header
+{
+    char magic[8];              ///< @c HASH_MAP_FILE_MAGIC
+    uint64_t count;             ///< Počet záznamů
+    uint64_t slot_count;        ///< Velikost indexu, mocnina dvou
+    uint64_t seed;              ///< Semínko hašovací funkce
+    uint64_t check;             ///< Haš @c HASH_MAP_FILE_CHECK_KEY
+    uint64_t slots_offset;      ///< Začátek indexu
+    uint64_t entries_offset;    ///< Začátek záznamů
+    uint64_t keys_offset;       ///< Začátek klíčů
+    uint64_t length;            ///< Velikost souboru
+} hash_map_file_header_t;
+
+/**
+ * @brief Záznam souboru z @c hash_map_save.
+ */
+typedef struct hash_map_file_entry
+{
+    uint64_t hash;              ///< Haš klíče
+    uint64_t key_offset;        ///< Začátek klíče v oblasti klíčů
+    uint32_t length;            ///< Délka klíče
+    int32_t value;              ///< Hodnota
+} hash_map_file_entry_t;
+
+hash_map_state_code_t hash_map_save(hash_map_t* self, const char* path)
+{
+    if (self->value_size != 0 || self->used > UINT32_MAX)
+    {
+        return VALUE_ERROR;
+    }
+
+    // index souboru je zaplnen nejvyse ze 3/4, vzdy zustava volna pozice
+    uint64_t slot_count = HASH_MAP_INIT_SIZE;
+    while ((uint64_t)self->used * 4 > slot_count * 3)
+    {
+        slot_count <<= 1;
+    }
+    uint64_t* slots = (uint64_t*)calloc(slot_count, sizeof(uint64_t));
+    if (slots == NULL)
+    {
+        // alokace pameti selhala
+        return MEMORY_ERROR;
+    }
+    uint32_t order = 0;
+    for (hash_map_item_t* item = self->first; item != NULL; item = item->next)
+    {
+        uint64_t hash = item->hash;
+        uint64_t idx = hash & (slot_count - 1);
+        while (slots[idx] != 0)
+        {
+            idx = (idx + 1) & (slot_count - 1);
+        }
+        // horni polovina hase jako otisk, v dolni poradi zaznamu od 1
+        slots[idx] = (hash >> 32 << 32) | ++order;
+    }
+
+    hash_map_file_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, HASH_MAP_FILE_MAGIC, sizeof(header.magic));
+    header.count = self->used;
+    header.slot_count = slot_count;
+    header.seed = self->seed;
+    header.check = self->hash_function(HASH_MAP_FILE_CHECK_KEY, sizeof(HASH_MAP_FILE_CHECK_KEY) - 1,
+                                       self->seed);
+    header.slots_offset = sizeof(header);
+    header.entries_offset = header.slots_offset + slot_count * sizeof(uint64_t);
+    header.keys_offset = header.entries_offset + header.count * sizeof(hash_map_file_entry_t);
+    header.length = header.keys_offset + self->key_bytes;
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        free(slots);
+        return IO_ERROR;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(slots, sizeof(uint64_t), slot_count, file) == slot_count;
+    free(slots);
+
+    uint64_t key_offset = 0;
+    for (hash_map_item_t* item = self->first; ok && item != NULL; item = item->next)
+    {
+        hash_map_file_entry_t entry;
+        entry.hash = item->hash;
+        entry.key_offset = key_offset;
+        entry.length = item->length;
+        entry.value = item->value;
+        ok = fwrite(&entry, sizeof(entry), 1, file) == 1;
+        key_offset += item->length + 1;
+    }
+    for (hash_map_item_t* item = self->first; ok && item != NULL; item = item->next)
+    {
+        ok = fwrite(item->key, 1, item->length + 1, file) == item->length + 1;
+    }
+
+    if (fclose(file) != 0 || !ok)
+    {
+        // neuplny soubor se neponecha
+        remove(path);
+        return IO_ERROR;
+    }
     return OK;
 }
 
+/**
+ * @brief Načte celý soubor do paměti, pro @c hash_map_open_mapped.
+ *
+ * Na POSIX systémech se soubor jen namapuje, jinde se přečte do alokované
+ * paměti.
+ *
+ * @param[in]  path   Cesta k souboru.
+ * @param[out] length Velikost souboru.
+ * @param[out] mapped @c true pokud je soubor namapovaný.
+ *
+ * @return Data souboru, nebo @c NULL při chybě.
+ */
+static const char* hash_map_file_load(const char* path, size_t* length, bool* mapped)
+{
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    struct stat info;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+    {
+        data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    // mapovani zustava platne i po zavreni souboru
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        return NULL;
+    }
+    *length = (size_t)info.st_size;
+    *mapped = true;
+    return (const char*)data;
+#else
+    FILE* file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return NULL;
+    }
+    char* data = NULL;
+    long size = -1;
+    if (fseek(file, 0, SEEK_END) == 0 && (size = ftell(file)) > 0 && fseek(file, 0, SEEK_SET) == 0)
+    {
+        data = (char*)malloc((size_t)size);
+    }
+    if (data != NULL && fread(data, 1, (size_t)size, file) != (size_t)size)
+    {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+    *length = (size_t)size;
+    *mapped = false;
+    return data;
+#endif
+}
+
+/**
+ * @brief Uvolní data souboru z @c hash_map_file_load.
+ */
+static void hash_map_file_unload(const char* data, size_t length, bool mapped)
+{
+#ifndef _WIN32
+    if (mapped)
+    {
+        munmap((void*)data, length);
+        return;
+    }
+#endif
+    (void)length;
+    (void)mapped;
+    free((void*)data);
+}
+
+hash_map_mapped_t* hash_map_open_mapped(const char* path, hash_map_hash_function_t hash_function)
+{
+    size_t length = 0;
+    bool mapped = false;
+    const char* data = hash_map_file_load(path, &length, &mapped);
+    if (data == NULL)
+    {
+        return NULL;
+    }
+
+    // kontrola hlavicky, posuny musi odpovidat velikosti souboru
+    hash_map_file_header_t header;
+    bool valid = length >= sizeof(header);
+    if (valid)
+    {
+        memcpy(&header, data, sizeof(header));
+        valid = memcmp(header.magic, HASH_MAP_FILE_MAGIC, sizeof(header.magic)) == 0 &&
+                header.length == length &&
+                header.slot_count != 0 && (header.slot_count & (header.slot_count - 1)) == 0 &&
+                header.count < header.slot_count &&
+                header.slot_count <= (length - sizeof(header)) / sizeof(uint64_t) &&
+                header.slots_offset == sizeof(header) &&
+                header.entries_offset == header.slots_offset + header.slot_count * sizeof(uint64_t) &&
+                header.keys_offset == header.entries_offset + header.count * sizeof(hash_map_file_entry_t) &&
+                header.keys_offset <= length;
+    }
+    if (hash_function == NULL)
+    {
+        hash_function = hash_map_hash_wy;
+    }
+    valid = valid && hash_function(HASH_MAP_FILE_CHECK_KEY, sizeof(HASH_MAP_FILE_CHECK_KEY) - 1,
+                                   (size_t)header.seed) == header.check;
+
+    // kontrola slotu, hledani pak skonci na prazdnem slotu a cte jen existujici zaznamy
+    bool empty_slot = false;
+    for (uint64_t i = 0; valid && i < header.slot_count; i++)
+    {
+        uint64_t slot;
+        memcpy(&slot, data + header.slots_offset + i * sizeof(uint64_t), sizeof(slot));
+        empty_slot = empty_slot || slot == 0;
+        valid = slot == 0 || (uint64_t)(uint32_t)slot - 1 < header.count;
+    }
+    valid = valid && empty_slot;
+
+    hash_map_mapped_t* self = valid ? (hash_map_mapped_t*)malloc(sizeof(hash_map_mapped_t)) : NULL;
+    if (self == NULL)
+    {
+        hash_map_file_unload(data, length, mapped);
+        return NULL;
+    }
+    self->data = data;
+    self->length = length;
+    self->slots = (const uint64_t*)(data + header.slots_offset);
+    self->slot_count = (size_t)header.slot_count;
+    self->entries = data + header.entries_offset;
+    self->keys = data + header.keys_offset;
+    self->keys_length = (size_t)(length - header.keys_offset);
+    self->count = (size_t)header.count;
+    self->hash_function = hash_function;
+    self->seed = (size_t)header.seed;
+    self->mapped = mapped;
+    return self;
+}
+
+void hash_map_mapped_close(hash_map_mapped_t* self)
+{
+    hash_map_file_unload(self->data, self->length, self->mapped);
+    free(self);
+}
+
+size_t hash_map_mapped_size(const hash_map_mapped_t* self)
+{
+    return self->count;
+}
+
+hash_map_state_code_t hash_map_mapped_get_key(const hash_map_mapped_t* self, const char* key,
+                                              size_t length, int* dst)
+{
+    uint64_t hash = self->hash_function(key, length, self->seed);
+    size_t mask = self->slot_count - 1;
+    size_t idx = (size_t)(hash & mask);
+    uint32_t tag = (uint32_t)(hash >> 32);
+
+    // nejvyse slot_count kroku, i kdyby v tabulce nebyl prazdny slot
+    for (size_t step = 0; step < self->slot_count; step++)
+    {
+        uint64_t slot = self->slots[idx];
+        if (slot == 0)
+        {
+            break;
+        }
+        // zaznam se cte az kdyz souhlasi otisk, poradi 0 neodpovida zadnemu zaznamu
+        uint32_t order = (uint32_t)slot;
+        if ((uint32_t)(slot >> 32) == tag && (size_t)order - 1 < self->count)
+        {
+            const hash_map_file_entry_t* entry =
+                (const hash_map_file_entry_t*)self->entries + (order - 1);
+            if (entry->hash == hash && entry->length == length &&
+                entry->key_offset < self->keys_length && length < self->keys_length - entry->key_offset &&
+                memcmp(self->keys + entry->key_offset, key, length) == 0)
+            {
+                *dst = entry->value;
+                return OK;
+            }
+        }
+        idx = (idx + 1) & mask;
+    }
+    return KEY_ERROR;
+}
+
+hash_map_state_code_t hash_map_mapped_get(const hash_map_mapped_t* self, const char* key, int* dst)
+{
+    return hash_map_mapped_get_key(self, key, strlen(key), dst);
+}
+
+bool hash_map_mapped_contains(const hash_map_mapped_t* self, const char* key)
+{
+    int dst;
+    return hash_map_mapped_get(self, key, &dst) == OK;
+}
+
+/**
+ * @brief Část souběžné tabulky.
+ *
+ * Zarovnání na řádek cache, aby zámky sousedních částí nesdílely řádek.
+ */
+struct alignas(64) hash_map_shard
+{
+    std::shared_mutex lock;     ///< Zámek části
+    hash_map_t* map;            ///< Tabulka části
+};
+
+/**
+ * @brief Část souběžné tabulky pro daný haš.
+ *
+ * Index i otisk používají jiné bity haše, část se proto vybírá podle horních
+ * bitů haše po promíchání jinou konstantou.
+ */
+static inline hash_map_shard_t* hash_map_concurrent_shard(hash_map_concurrent_t* self, size_t hash)
+{
+    if (self->shard_bits == 0)
+    {
+        return self->shards;
+    }
+    return self->shards + (((uint64_t)hash * 0xff51afd7ed558ccdULL) >> (64 - self->shard_bits));
+}
+
+hash_map_concurrent_t* hash_map_concurrent_ctor(size_t shards, const hash_map_config_t* config)
+{
+    if (shards == 0)
+    {
+        shards = HASH_MAP_CONCURRENT_SHARDS;
+    }
+    unsigned bits = 0;
+    while (((size_t)1 << bits) < shards)
+    {
+        bits++;
+    }
+
+    hash_map_concurrent_t* self = (hash_map_concurrent_t*)malloc(sizeof(hash_map_concurrent_t));
+    if (self == NULL)
+    {
+        return NULL;
+    }
+    self->shard_count = (size_t)1 << bits;
+    self->shard_bits = bits;
+    self->shards = new (std::nothrow) hash_map_shard_t[self->shard_count];
+    if (self->shards == NULL)
+    {
+        free(self);
+        return NULL;
+    }
+
+    // vsechny casti maji stejnou hasovaci funkci i seminko, has se pocita jednou
+    hash_map_config_t shard_config = config != NULL ? *config : hash_map_config_t();
+    shard_config.capacity = (shard_config.capacity + self->shard_count - 1) / self->shard_count;
+    shard_config.value_size = 0;
+    for (size_t i = 0; i < self->shard_count; i++)
+    {
+        self->shards[i].map = hash_map_ctor_with_config(&shard_config);
+        if (self->shards[i].map == NULL)
+        {
+            // alokace pameti selhala
+            self->shard_count = i;
+            hash_map_concurrent_dtor(self);
+            return NULL;
+        }
+    }
+    return self;
+}
+
+void hash_map_concurrent_dtor(hash_map_concurrent_t* self)
+{
+    for (size_t i = 0; i < self->shard_count; i++)
+    {
+        hash_map_dtor(self->shards[i].map);
+    }
+    delete[] self->shards;
+    free(self);
+}
+
+size_t hash_map_concurrent_size(hash_map_concurrent_t* self)
+{
+    size_t size = 0;
+    for (size_t i = 0; i < self->shard_count; i++)
+    {
+        std::shared_lock<std::shared_mutex> guard(self->shards[i].lock);
+        size += hash_map_size(self->shards[i].map);
+    }
+    return size;
+}
+
+bool hash_map_concurrent_contains(hash_map_concurrent_t* self, const char* key)
+{
+    // has se spocita jeste pred zamcenim casti
+    size_t length = strlen(key);
+    size_t hash = hash_map_hash_key(self->shards[0].map, key, length);
+    hash_map_shard_t* shard = hash_map_concurrent_shard(self, hash);
+    std::shared_lock<std::shared_mutex> guard(shard->lock);
+    return hash_map_contains_hashed(shard->map, key, length, hash);
+}
+
+hash_map_state_code_t hash_map_concurrent_put(hash_map_concurrent_t* self, const char* key,
+                                              int value)
+{
+    size_t length = strlen(key);
+    size_t hash = hash_map_hash_key(self->shards[0].map, key, length);
+    hash_map_shard_t* shard = hash_map_concurrent_shard(self, hash);
+    std::unique_lock<std::shared_mutex> guard(shard->lock);
+    return hash_map_put_hashed(shard->map, key, length, hash, value);
+}
+
+hash_map_state_code_t hash_map_concurrent_get(hash_map_concurrent_t* self, const char* key,
+                                              int* dst)
+{
+    size_t length = strlen(key);
+    size_t hash = hash_map_hash_key(self->shards[0].map, key, length);
+    hash_map_shard_t* shard = hash_map_concurrent_shard(self, hash);
+    std::shared_lock<std::shared_mutex> guard(shard->lock);
+    return hash_map_get_hashed(shard->map, key, length, hash, dst);
+}
+
+hash_map_state_code_t hash_map_concurrent_pop(hash_map_concurrent_t* self, const char* key,
+                                              int* dst)
+{
+    size_t length = strlen(key);
+    size_t hash = hash_map_hash_key(self->shards[0].map, key, length);
+    hash_map_shard_t* shard = hash_map_concurrent_shard(self, hash);
+    std::unique_lock<std::shared_mutex> guard(shard->lock);
+    return hash_map_pop_hashed(shard->map, key, length, hash, dst);
+}
+
+hash_map_state_code_t hash_map_concurrent_remove(hash_map_concurrent_t* self, const char* key)
+{
+    int dst;
+    return hash_map_concurrent_pop(self, key, &dst);
+}
+
 /*** Konec souboru white_box_code.cpp ***/
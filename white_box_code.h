@@ -26,17 +26,38 @@
 #include <string.h>     
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 /** Inicializační velikost tabulky. */
 #define HASH_MAP_INIT_SIZE 8                    
 /** Parametr použit v hledání dalšího indexu při kolizi. */
 #define HASH_MAP_PERTURB_SHIFT 5                
 /** Mez zaplnění kdy se má realokovat velikost tabulky. */
-#define HASH_MAP_REALLOCATION_THRESHOLD 3/5.
+#define HASH_MAP_REALLOCATION_THRESHOLD 2/3.
+/** Počet pozic indexu ve skupině prohledávané jedinou instrukcí. */
+#define HASH_MAP_GROUP_WIDTH 16
+/** Mez zaplnění pro realokaci u skupinového prohledávání. */
+#define HASH_MAP_GROUP_THRESHOLD 7/8.
+/** Zarovnání hodnot uložených v položkách, viz @c hash_map_config_t::value_size. */
+#define HASH_MAP_VALUE_ALIGN 16
+/** Počet pozic starého indexu převedených při jedné změně, viz @c hash_map_config_t::incremental. */
+#define HASH_MAP_MIGRATE_STEP 8
+/** Počet klíčů, jejichž pozice se v dávkových funkcích přednačítají najednou. */
+#define HASH_MAP_BATCH_SIZE 16
+/** Výchozí počet částí souběžné tabulky, viz @c hash_map_concurrent_t. */
+#define HASH_MAP_CONCURRENT_SHARDS 64
 /** Hyperparametr v hašovácí funkci. */
 #define HASH_FUNCTION_PARAM_A 1794967309        
 /** Hyperparametr v hašovácí funkci. */
 #define HASH_FUNCTION_PARAM_B 7                 
+/** Velikost prvního bloku areny v bajtech. */
+#define HASH_MAP_ARENA_FIRST_CHUNK 4096
+/** Maximální velikost bloku areny v bajtech. */
+#define HASH_MAP_ARENA_MAX_CHUNK (1 << 20)
+/** Zarovnání a granularita velikosti položek v areně. */
+#define HASH_MAP_ARENA_ALIGN 16
+/** Počet velikostních tříd se seznamem volných položek v areně. */
+#define HASH_MAP_ARENA_CLASSES 16
 
 // Informace pro C++ překladač, aby použil "C" linker pro následující funkce.
 extern "C" {
@@ -57,9 +78,69 @@ typedef enum {
     MEMORY_ERROR,           ///< Problém při alokaci paměti.
     VALUE_ERROR,            ///< Neplatná hodnota argumentu.
     KEY_ERROR,              ///< Přístup ke klíči který není vložen v tabulce.
-    KEY_ALREADY_EXISTS      ///< Klíč již v hašovací tabulce existuje.
+    KEY_ALREADY_EXISTS,     ///< Klíč již v hašovací tabulce existuje.
+    IO_ERROR                ///< Chyba při zápisu nebo čtení souboru.
 } hash_map_state_code_t;
 
+/**
+ * @brief Způsob prohledávání indexu.
+ */
+typedef enum {
+    /** Pozice po jedné podle posloupnosti s @c HASH_MAP_PERTURB_SHIFT. */
+    HASH_MAP_ENGINE_PERTURB,
+    /**
+     * Po skupinách @c HASH_MAP_GROUP_WIDTH pozic, otisky celé skupiny se
+     * porovnají jedinou SIMD instrukcí (SSE2), skupiny se procházejí lineárně.
+     */
+    HASH_MAP_ENGINE_GROUP
+} hash_map_engine_t;
+
+/**
+ * @brief Hašovací funkce klíčů.
+ *
+ * @param[in] key    Klíč.
+ * @param[in] length Délka klíče bez ukončovacího znaku.
+ * @param[in] seed   Semínko, různá semínka dávají nezávislé haše.
+ *
+ * @return Haš klíče.
+ */
+typedef size_t (*hash_map_hash_function_t)(const char* key, size_t length,
+                                           size_t seed);
+
+/**
+ * @brief Nastavení hašovací tabulky pro @c hash_map_ctor_with_config.
+ *
+ * Nulová hodnota položky znamená výchozí nastavení, strukturu je tedy vhodné
+ * nejprve vynulovat a nastavit jen potřebné položky.
+ */
+typedef struct hash_map_config
+{
+    /** Hašovací funkce, @c NULL znamená @c hash_map_hash_wy. */
+    hash_map_hash_function_t hash_function;
+    size_t seed;                ///< Semínko předávané hašovací funkci
+    /** Položky a klíče se přidělují z bloků areny, viz @c hash_map_arena_t. */
+    bool arena;
+    hash_map_engine_t engine;   ///< Způsob prohledávání indexu
+    /** Index se zmenší na polovinu, když zaplnění klesne pod čtvrtinu meze. */
+    bool shrink;
+    /** Počet klíčů, které se vloží bez realokace indexu, 0 znamená výchozí. */
+    size_t capacity;
+    /**
+     * Velikost hodnoty v bajtech uložené v každé položce mezi strukturou
+     * položky a klíčem, viz @c hash_map_emplace_hashed. 0 znamená jen @c int
+     * hodnoty položky.
+     */
+    size_t value_size;
+    /**
+     * Postupné zvětšování indexu: při překročení meze zaplnění se alokuje
+     * nový index a položky se do něj převádí po @c HASH_MAP_MIGRATE_STEP
+     * pozicích starého indexu při každém vložení a odstranění. Do dokončení
+     * se hledá v obou indexech. Ostatní přestavby indexu (@c hash_map_reserve,
+     * zmenšení, odstranění @c dummy) proběhnou naráz.
+     */
+    bool incremental;
+} hash_map_config_t;
+
 /**
  * @brief Záznam v hašovací tabulce.
  * 
@@ -69,6 +150,10 @@ typedef enum {
  * pouze ukazatele do tohoto seznamu. Pořadí položek v seznamu odpovídá pořadí 
  * vložení daného klíče do tabulky. 
  * 
+ * Klíč je uložen ve stejném bloku paměti hned za položkou, vložení nového klíče
+ * tedy znamená jedinou alokaci a @c key ukazuje za konec struktury. Klíče se
+ * porovnávají podle délky a @c memcmp, uložený klíč je navíc ukončen nulou.
+ * 
  * Uživatel by k položkám struktury neměl přistupovat přímo, ale pomocí 
  * definovaného rozhraní níže. Nicméně v rámci testování můžete přímo testovat, 
  * zda rozhraní pracuje s tímto datovým typem korektně.
@@ -78,10 +163,40 @@ typedef struct hash_map_item
     char* key;                  ///< Klíč
     size_t hash;                ///< Hash
     int value;                  ///< Uložená hodnota
+    unsigned int length;        ///< Délka klíče
     struct hash_map_item* next; ///< Následující položka 
     struct hash_map_item* prev; ///< Předcházející položka
 } hash_map_item_t;
 
+/**
+ * @brief Blok paměti areny, data následují hned za hlavičkou.
+ */
+typedef struct hash_map_arena_chunk
+{
+    struct hash_map_arena_chunk* next; ///< Dříve alokovaný blok
+    size_t size;                ///< Velikost dat bloku v bajtech
+} hash_map_arena_chunk_t;
+
+/**
+ * @brief Arena pro položky hašovací tabulky.
+ *
+ * Položky (včetně klíče) se přidělují postupně z bloků, jejichž velikost roste
+ * geometricky do @c HASH_MAP_ARENA_MAX_CHUNK. Velikost položky se zaokrouhluje
+ * na násobek @c HASH_MAP_ARENA_ALIGN a odebrané položky se vrací do seznamu
+ * volných položek své velikostní třídy, odkud je znovu použije další vložení.
+ * Položky větší než největší třída se znovu nepoužijí až do vyprázdnění
+ * tabulky. @c hash_map_clear uvolní celou arenu několika voláními @c free bez
+ * procházení položek.
+ */
+typedef struct hash_map_arena
+{
+    hash_map_arena_chunk_t* chunks; ///< Naposledy alokovaný blok
+    char* cursor;               ///< Začátek nepoužité části posledního bloku
+    size_t remaining;           ///< Velikost nepoužité části posledního bloku
+    /** Seznamy volných položek podle velikostní třídy, spojené přes @c next. */
+    struct hash_map_item* free_items[HASH_MAP_ARENA_CLASSES];
+} hash_map_arena_t;
+
 /**
  * @brief Datový typ hašovací tabulky. 
  * 
@@ -92,14 +207,117 @@ typedef struct hash_map_item
 typedef struct hash_map
 {
     hash_map_item_t** index;    ///< Index hašovací tabulky
+    /**
+     * Otisky hašů položek, stejná velikost jako index. Pozice, jejíž otisk se
+     * liší od otisku hledaného haše, se při vyhledávání přeskočí bez čtení
+     * položky. Otisk volné pozice nebo pozice s @c dummy nemá význam.
+     *
+     * U @c HASH_MAP_ENGINE_GROUP má obsazená pozice 7bitový otisk a volná či
+     * odstraněná pozice speciální hodnotu s nastaveným nejvyšším bitem.
+     */
+    unsigned char* tags;
     hash_map_item_t* first;     ///< První položka v seznamu
     hash_map_item_t* last;      ///< Poslední položka v seznamu
     /** Při odstranění je položka v indexu nahrazena tímto ukazatelem. */
     hash_map_item_t* dummy;     
     size_t allocated;           ///< Alokované místo (velikost indexu)
     size_t used;                ///< Počet vložených položek (velikost seznamu)
+    /** Počet odstraněných pozic indexu (@c dummy), uvolní je až nový index. */
+    size_t deleted;
+    hash_map_hash_function_t hash_function; ///< Hašovací funkce klíčů
+    size_t seed;                ///< Semínko hašovací funkce
+    /** Arena pro položky, @c NULL pokud se položky alokují jednotlivě. */
+    hash_map_arena_t* arena;
+    hash_map_engine_t engine;   ///< Způsob prohledávání indexu
+    bool shrink;                ///< Zmenšování indexu po odstranění položek
+    size_t value_size;          ///< Velikost hodnoty uložené v položce
+    bool incremental;           ///< Postupné zvětšování indexu
+    /**
+     * Index před zvětšením, jehož položky se ještě převádějí, jinak @c NULL.
+     * Převedené pozice obsahují @c dummy.
+     */
+    hash_map_item_t** old_index;
+    unsigned char* old_tags;    ///< Otisky starého indexu
+    size_t old_allocated;       ///< Velikost starého indexu
+    size_t migrated;            ///< Počet již převedených pozic starého indexu
+    size_t key_bytes;           ///< Součet délek klíčů včetně ukončovací nuly
+    size_t resizes;             ///< Počet přestaveb indexu
+    /** Počet vyhledávání v indexu, počítá se jen s @c HASH_MAP_STATS. */
+    size_t lookups;
+    /** Počet prohledaných pozic (skupin), počítá se jen s @c HASH_MAP_STATS. */
+    size_t lookup_probes;
 } hash_map_t;
 
+/**
+ * @brief Statistiky hašovací tabulky, viz @c hash_map_stats.
+ *
+ * Velikosti jsou v bajtech. Délka hledání je počet prohledaných pozic indexu
+ * (u @c HASH_MAP_ENGINE_GROUP počet skupin) od první pozice haše po pozici
+ * klíče, klíč na své první pozici má délku 1.
+ */
+typedef struct hash_map_stats
+{
+    size_t size;                ///< Počet záznamů
+    size_t capacity;            ///< Velikost indexu
+    size_t tombstones;          ///< Počet odstraněných pozic (@c dummy) v indexu
+    double load_factor;         ///< Podíl obsazených pozic indexu
+    /** Podíl obsazených a odstraněných pozic, při dosažení meze se index přestaví. */
+    double fill_factor;
+    size_t index_bytes;         ///< Index a otisky, včetně starého indexu
+    size_t item_bytes;          ///< Struktury položek a hodnoty v nich
+    size_t key_bytes;           ///< Klíče včetně ukončovací nuly
+    /** Bloky areny včetně volného místa, 0 bez areny. */
+    size_t arena_bytes;
+    /** Celková paměť tabulky bez režie alokátoru. */
+    size_t total_bytes;
+    size_t resizes;             ///< Počet přestaveb indexu od vytvoření
+    double probe_average;       ///< Průměrná délka hledání uložených klíčů
+    size_t probe_max;           ///< Nejdelší hledání uloženého klíče
+    size_t lookups;             ///< Počet vyhledávání (@c HASH_MAP_STATS)
+    size_t lookup_probes;       ///< Prohledané pozice všech vyhledávání (@c HASH_MAP_STATS)
+} hash_map_stats_t;
+
+/**
+ * @brief Převzetí hodnoty odstraňované položky.
+ *
+ * @param[in] value   Hodnota v položce, po návratu se paměť uvolní.
+ * @param[in] context Ukazatel předaný volajícím.
+ */
+typedef void (*hash_map_value_consumer_t)(void* value, void* context);
+
+/*******************************************************************************
+ * Hašovací funkce
+ ******************************************************************************/
+/**
+ * @brief Původní aditivní hašovací funkce.
+ *
+ * Sčítá @c A*c+B přes všechny znaky klíče, takže všechny přesmyčky mají stejný
+ * haš a podobné klíče tvoří dlouhé řetězce kolizí. Zachována pro testování
+ * kolizí a srovnání, semínko ignoruje.
+ *
+ * @param[in] key    Klíč.
+ * @param[in] length Délka klíče.
+ * @param[in] seed   Semínko (nepoužito).
+ *
+ * @return Haš klíče.
+ */
+size_t hash_map_hash_additive(const char* key, size_t length, size_t seed);
+
+/**
+ * @brief Rychlá hašovací funkce ve stylu wyhash (výchozí).
+ *
+ * Zpracovává klíč po 8 bajtech a míchá je 64x64->128 bitovým násobením, krátké
+ * klíče (do 16 bajtů) přečte nejvýše čtyřmi čteními bez cyklu. Změna libovolného
+ * bitu klíče nebo semínka ovlivní všechny bity haše.
+ *
+ * @param[in] key    Klíč.
+ * @param[in] length Délka klíče.
+ * @param[in] seed   Semínko.
+ *
+ * @return Haš klíče.
+ */
+size_t hash_map_hash_wy(const char* key, size_t length, size_t seed);
+
 /*******************************************************************************
  * Inicializace, deinicializace & alokace paměti
  ******************************************************************************/
@@ -124,6 +342,77 @@ typedef struct hash_map
  */
 hash_map_t* hash_map_ctor();
 
+/**
+ * @brief Konstruktor hašovací tabulky se zadaným nastavením.
+ *
+ * Stejné jako @c hash_map_ctor, navíc umožňuje zvolit hašovací funkci,
+ * semínko a přidělování položek z areny.
+ *
+ * Příklad užití:
+ * @code{.c}
+ * hash_map_config_t config = {0};
+ * config.hash_function = hash_map_hash_additive;
+ * hash_map_t* map = hash_map_ctor_with_config(&config);
+ * // do something
+ * hash_map_dtor(map);
+ * @endcode
+ *
+ * @param[in] config Nastavení tabulky, @c NULL znamená výchozí nastavení.
+ *
+ * @return Ukazatel na inicializovanou hašovací tabulku. V případě chyby alokace
+ *         vrací hodnotu @c NULL.
+ *
+ * @see hash_map_ctor
+ */
+hash_map_t* hash_map_ctor_with_config(const hash_map_config_t* config);
+
+/**
+ * @brief Konstruktor hašovací tabulky pro známý počet klíčů.
+ *
+ * Index je od začátku tak velký, aby vložení @p capacity klíčů nevyvolalo
+ * realokaci. Velikost indexu je nejmenší mocnina dvou od
+ * @c HASH_MAP_INIT_SIZE, kterou @p capacity klíčů zaplní nejvýše do meze.
+ *
+ * Příklad užití:
+ * @code{.c}
+ * hash_map_t* map = hash_map_ctor_with_capacity(1000);
+ * // hash_map_capacity(map) == 2048
+ * hash_map_dtor(map);
+ * @endcode
+ *
+ * @param[in] capacity Počet klíčů.
+ *
+ * @return Ukazatel na inicializovanou hašovací tabulku. V případě chyby alokace
+ *         vrací hodnotu @c NULL.
+ *
+ * @see hash_map_ctor_with_config, hash_map_reserve
+ */
+hash_map_t* hash_map_ctor_with_capacity(size_t capacity);
+
+/**
+ * @brief Konstruktor hašovací tabulky se zvoleným způsobem prohledávání.
+ *
+ * Oba způsoby mají stejné rozhraní i pořadí položek v seznamu, liší se jen
+ * indexem. U @c HASH_MAP_ENGINE_GROUP je velikost indexu vždy násobkem
+ * @c HASH_MAP_GROUP_WIDTH a realokuje se až při zaplnění
+ * @c HASH_MAP_GROUP_THRESHOLD.
+ *
+ * Příklad užití:
+ * @code{.c}
+ * hash_map_t* map = hash_map_ctor_with_engine(HASH_MAP_ENGINE_GROUP);
+ * // hash_map_capacity(map) == 16
+ * hash_map_dtor(map);
+ * @endcode
+ *
+ * @param[in] engine Způsob prohledávání indexu.
+ *
+ * @return Ukazatel na inicializovanou hašovací tabulku. V případě chyby alokace
+ *         vrací hodnotu @c NULL.
+ *
+ * @see hash_map_ctor_with_config
+ */
+hash_map_t* hash_map_ctor_with_engine(hash_map_engine_t engine);
+
 /**
  * @brief Destruktor hašovací tabulky.
  *  
@@ -206,6 +495,29 @@ size_t hash_map_size(hash_map_t* self);
  */
 size_t hash_map_capacity(hash_map_t* self);
 
+/**
+ * @brief Haš klíče hašovací funkcí a semínkem tabulky.
+ *
+ * Haš lze spočítat jednou a předat ho variantám @c hash_map_*_hashed, např.
+ * při ověření klíče a jeho následném vložení.
+ *
+ * Příklad užití:
+ * @code{.c}
+ * size_t hash = hash_map_hash_key(map, buffer, length);
+ * if (!hash_map_contains_hashed(map, buffer, length, hash))
+ * {
+ *     hash_map_put_hashed(map, buffer, length, hash, 5);
+ * }
+ * @endcode
+ *
+ * @param[in] self   Ukazatel na strukturu hašovací tabulky.
+ * @param[in] key    Klíč, nemusí být ukončen nulou.
+ * @param[in] length Délka klíče.
+ *
+ * @return Haš klíče.
+ */
+size_t hash_map_hash_key(hash_map_t* self, const char* key, size_t length);
+
 /**
  * @brief Obsahuje tabulka záznam s daným klíčem?
  * 
@@ -220,11 +532,46 @@ size_t hash_map_capacity(hash_map_t* self);
  */
 bool hash_map_contains(hash_map_t* self, const char* key);
 
+/**
+ * @brief Varianta @c hash_map_contains se známou délkou a hašem klíče.
+ *
+ * @param[in] self   Ukazatel na strukturu hašovací tabulky.
+ * @param[in] key    Klíč, nemusí být ukončen nulou.
+ * @param[in] length Délka klíče.
+ * @param[in] hash   Haš klíče z @c hash_map_hash_key.
+ *
+ * @return Nenulová hodnota pokud se záznam asociován se zadaným klíčem nachází 
+ *         v tabulce.
+ */
+bool hash_map_contains_hashed(hash_map_t* self, const char* key, size_t length,
+                              size_t hash);
+
+/**
+ * @brief Obsahuje tabulka záznamy s danými klíči?
+ *
+ * Dávková varianta @c hash_map_contains. Klíče se zpracovávají po
+ * @c HASH_MAP_BATCH_SIZE, u každé dávky se nejprve spočítají všechny haše a
+ * přednačtou se pozice indexu a položky, takže se výpadky cache jednotlivých
+ * klíčů překrývají.
+ *
+ * @param[in]  self  Ukazatel na strukturu hašovací tabulky.
+ * @param[in]  keys  Pole klíčů.
+ * @param[in]  count Počet klíčů.
+ * @param[out] found Pole @p count hodnot, zda tabulka obsahuje klíč, nebo
+ *                   @c NULL.
+ *
+ * @return Počet nalezených klíčů.
+ */
+size_t hash_map_contains_many(hash_map_t* self, const char* const* keys, size_t count,
+                              bool* found);
+
 /**
  * @brief Vloží klíč a hodnotu do tabulky.
  * 
  * Pokud je již index tabulky zaplněn ze 2/3, realokuje pro index 2x větší místo
- * v paměti a provede reindexaci. Pokud tabulka již obsahuje k danému klíči 
+ * v paměti a provede reindexaci. Do zaplnění se počítají i odstraněné pozice,
+ * pokud by ale po jejich odstranění byl index zaplněn nejvýše do poloviny
+ * meze, index se jen přestaví ve stejné velikosti. Pokud tabulka již obsahuje k danému klíči 
  * záznam, hodnota záznamu se přepíše a funkce vrací hodnotu 
  * @c KEY_ALREADY_EXISTS .
  * 
@@ -245,6 +592,43 @@ bool hash_map_contains(hash_map_t* self, const char* key);
 hash_map_state_code_t hash_map_put(hash_map_t* self, const char* key, 
                                    int value);
 
+/**
+ * @brief Varianta @c hash_map_put se známou délkou a hašem klíče.
+ *
+ * Do tabulky se zkopíruje @p length bajtů klíče a ukončovací nula.
+ *
+ * @param[in] self   Ukazatel na strukturu hašovací tabulky.
+ * @param[in] key    Klíč, nemusí být ukončen nulou.
+ * @param[in] length Délka klíče.
+ * @param[in] hash   Haš klíče z @c hash_map_hash_key.
+ * @param[in] value  Hodnota k uložení.
+ *
+ * @return Vrací @c KEY_ALREADY_EXISTS pokud se klíč nachází v tabulce,
+ *         @c VALUE_ERROR pokud je klíč delší než @c UINT_MAX, jinak @c OK.
+ */
+hash_map_state_code_t hash_map_put_hashed(hash_map_t* self, const char* key,
+                                          size_t length, size_t hash, int value);
+
+/**
+ * @brief Vloží klíče a hodnoty do tabulky.
+ *
+ * Dávková varianta @c hash_map_put se stejným výsledkem jako postupné volání
+ * pro jednotlivé klíče, viz @c hash_map_contains_many.
+ *
+ * @param[in]  self    Ukazatel na strukturu hašovací tabulky.
+ * @param[in]  keys    Pole klíčů.
+ * @param[in]  values  Pole hodnot k uložení.
+ * @param[in]  count   Počet klíčů.
+ * @param[out] results Pole @p count návratových hodnot @c hash_map_put pro
+ *                     jednotlivé klíče, nebo @c NULL.
+ *
+ * @return @c MEMORY_ERROR pokud selhala alokace, klíče za ním se nevloží,
+ *         jinak @c OK.
+ */
+hash_map_state_code_t hash_map_put_many(hash_map_t* self, const char* const* keys,
+                                        const int* values, size_t count,
+                                        hash_map_state_code_t* results);
+
 /**
  * @brief Uloží hodnotu asociovanou se zadaným klíčem na určené místo v paměti.
  * 
@@ -268,6 +652,46 @@ hash_map_state_code_t hash_map_put(hash_map_t* self, const char* key,
 hash_map_state_code_t hash_map_get(hash_map_t* self, const char* key, 
                                    int* value);
 
+/**
+ * @brief Varianta @c hash_map_get se známou délkou a hašem klíče.
+ *
+ * @param[in]  self   Ukazatel na strukturu hašovací tabulky.
+ * @param[in]  key    Klíč, nemusí být ukončen nulou.
+ * @param[in]  length Délka klíče.
+ * @param[in]  hash   Haš klíče z @c hash_map_hash_key.
+ * @param[out] value  Ukazatel na místo, kde se uloží hodnota.
+ *
+ * @return Vrací @c KEY_ERROR pokud se klíč nenachází v tabulce, 
+ *         jinak @c OK.
+ */
+hash_map_state_code_t hash_map_get_hashed(hash_map_t* self, const char* key,
+                                          size_t length, size_t hash, int* value);
+
+/**
+ * @brief Uloží hodnoty asociované se zadanými klíči.
+ *
+ * Dávková varianta @c hash_map_get, viz @c hash_map_contains_many. Hodnota
+ * nenalezeného klíče se v poli @p values nezmění.
+ *
+ * Příklad užití:
+ * @code{.c}
+ * const char* keys[] = {"aloha", "hello"};
+ * int values[2];
+ * size_t found = hash_map_get_many(map, keys, 2, values, NULL);
+ * @endcode
+ *
+ * @param[in]  self    Ukazatel na strukturu hašovací tabulky.
+ * @param[in]  keys    Pole klíčů.
+ * @param[in]  count   Počet klíčů.
+ * @param[out] values  Pole @p count míst pro hodnoty.
+ * @param[out] results Pole @p count návratových hodnot @c hash_map_get pro
+ *                     jednotlivé klíče, nebo @c NULL.
+ *
+ * @return Počet nalezených klíčů.
+ */
+size_t hash_map_get_many(hash_map_t* self, const char* const* keys, size_t count,
+                         int* values, hash_map_state_code_t* results);
+
 /**
  * @brief Uloží hodnotu z hašovací tabulky a odstraní záznam.
  * 
@@ -283,7 +707,7 @@ hash_map_state_code_t hash_map_get(hash_map_t* self, const char* key,
  * @endcode
  *
  * @warning Odstranění záznamu z tabulky neovlivňuje alokované místo pro 
- *          tabulku.
+ *          tabulku, pokud nebylo zapnuto zmenšování (@c hash_map_config_t::shrink).
  * 
  * @param[in]  self  Ukazatel na strukturu hašovací tabulky.
  * @param[in]  key   Klíč do tabulky.
@@ -297,6 +721,86 @@ hash_map_state_code_t hash_map_get(hash_map_t* self, const char* key,
 hash_map_state_code_t hash_map_pop(hash_map_t* self, const char* key, 
                                    int* value);
 
+/**
+ * @brief Varianta @c hash_map_pop se známou délkou a hašem klíče.
+ *
+ * @param[in]  self   Ukazatel na strukturu hašovací tabulky.
+ * @param[in]  key    Klíč, nemusí být ukončen nulou.
+ * @param[in]  length Délka klíče.
+ * @param[in]  hash   Haš klíče z @c hash_map_hash_key.
+ * @param[out] value  Ukazatel na místo, kde se uloží hodnota.
+ *
+ * @return Vrací @c KEY_ERROR pokud se klíč nenachází v tabulce, 
+ *         jinak @c OK.
+ */
+hash_map_state_code_t hash_map_pop_hashed(hash_map_t* self, const char* key,
+                                          size_t length, size_t hash, int* value);
+
+/*******************************************************************************
+ * Hodnoty uložené v položkách
+ ******************************************************************************/
+/**
+ * @brief Vyhledá klíč a případně vloží novou položku, vrací místo pro hodnotu.
+ *
+ * Pro tabulky s @c hash_map_config_t::value_size . Hodnota nové položky není
+ * inicializovaná, volající ji zkonstruuje přímo na vráceném místě. Položky se
+ * při realokaci indexu nepřesouvají, ukazatel na hodnotu tedy platí až do
+ * odstranění klíče. Tabulka hodnoty nikdy neinicializuje ani neruší, při
+ * odstranění položky nebo vyprázdnění tabulky jen uvolní jejich paměť.
+ *
+ * @param[in]  self     Ukazatel na strukturu hašovací tabulky.
+ * @param[in]  key      Klíč, nemusí být ukončen nulou.
+ * @param[in]  length   Délka klíče.
+ * @param[in]  hash     Haš klíče z @c hash_map_hash_key.
+ * @param[out] inserted @c true pokud byla položka nově vložena.
+ *
+ * @return Místo pro hodnotu zarovnané na @c HASH_MAP_VALUE_ALIGN, nebo @c NULL
+ *         při chybě alokace či klíči delším než @c UINT_MAX.
+ */
+void* hash_map_emplace_hashed(hash_map_t* self, const char* key, size_t length,
+                              size_t hash, bool* inserted);
+
+/**
+ * @brief Vyhledá hodnotu uloženou v položce s daným klíčem.
+ *
+ * @param[in] self   Ukazatel na strukturu hašovací tabulky.
+ * @param[in] key    Klíč, nemusí být ukončen nulou.
+ * @param[in] length Délka klíče.
+ * @param[in] hash   Haš klíče z @c hash_map_hash_key.
+ *
+ * @return Místo hodnoty, nebo @c NULL pokud se klíč nenachází v tabulce.
+ */
+void* hash_map_find_value_hashed(hash_map_t* self, const char* key, size_t length,
+                                 size_t hash);
+
+/**
+ * @brief Odstraní položku a předá její hodnotu před uvolněním paměti.
+ *
+ * @param[in] self    Ukazatel na strukturu hašovací tabulky.
+ * @param[in] key     Klíč, nemusí být ukončen nulou.
+ * @param[in] length  Délka klíče.
+ * @param[in] hash    Haš klíče z @c hash_map_hash_key.
+ * @param[in] consume Funkce, která hodnotu převezme (přesune, zruší), nebo
+ *                    @c NULL.
+ * @param[in] context Ukazatel předaný funkci @p consume.
+ *
+ * @return Vrací @c KEY_ERROR pokud se klíč nenachází v tabulce, 
+ *         jinak @c OK.
+ */
+hash_map_state_code_t hash_map_pop_value_hashed(hash_map_t* self, const char* key,
+                                                size_t length, size_t hash,
+                                                hash_map_value_consumer_t consume,
+                                                void* context);
+
+/**
+ * @brief Místo hodnoty v položce tabulky s @c hash_map_config_t::value_size .
+ *
+ * @param[in] item Položka tabulky.
+ *
+ * @return Místo hodnoty.
+ */
+void* hash_map_item_value(hash_map_item_t* item);
+
 /**
  * @brief Odstranění položky z hašovací tabulky.
  *
@@ -310,7 +814,7 @@ hash_map_state_code_t hash_map_pop(hash_map_t* self, const char* key,
  * @endcode
  * 
  * @warning Odstranění záznamu z tabulky neovlivňuje alokované místo pro 
- *          tabulku.
+ *          tabulku, pokud nebylo zapnuto zmenšování (@c hash_map_config_t::shrink).
  * 
  * @param[in] self Ukazatel na strukturu hašovací tabulky.
  * @param[in] key  Klíč do tabulky.
@@ -322,8 +826,620 @@ hash_map_state_code_t hash_map_pop(hash_map_t* self, const char* key,
  */
 hash_map_state_code_t hash_map_remove(hash_map_t* self, const char* key);
 
+/*******************************************************************************
+ * Procházení a uspořádání položek
+ ******************************************************************************/
+/**
+ * @brief Iterátor záznamů tabulky v pořadí vložení.
+ *
+ * Iterátor ukazuje na následující položku, vrácený záznam lze tedy během
+ * procházení odstranit. Jiné změny tabulky iterátor zneplatní.
+ */
+typedef struct hash_map_iter
+{
+    hash_map_item_t* item;      ///< Následující položka, @c NULL na konci
+} hash_map_iter_t;
+
+/**
+ * @brief Iterátor na první záznam tabulky.
+ *
+ * Příklad užití:
+ * @code{.c}
+ * hash_map_iter_t iter = hash_map_iter_begin(map);
+ * const char* key;
+ * int value;
+ * while (hash_map_iter_next(&iter, &key, NULL, &value))
+ * {
+ *     printf("%s: %d\n", key, value);
+ * }
+ * @endcode
+ *
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ *
+ * @return Iterátor.
+ */
+hash_map_iter_t hash_map_iter_begin(hash_map_t* self);
+
+/**
+ * @brief Vrátí záznam iterátoru a posune ho na další.
+ *
+ * @param[in,out] iter   Iterátor z @c hash_map_iter_begin.
+ * @param[out]    key    Klíč ukončený nulou, nebo @c NULL.
+ * @param[out]    length Délka klíče, nebo @c NULL.
+ * @param[out]    value  Hodnota, nebo @c NULL.
+ *
+ * @return @c false pokud už žádný záznam nezbývá, jinak @c true.
+ */
+bool hash_map_iter_next(hash_map_iter_t* iter, const char** key, size_t* length, int* value);
+
+/**
+ * @brief Přesune položky do jediného bloku areny v pořadí vložení.
+ *
+ * Položky rozházené po haldě (bez areny, nebo po mnoha odstraněních) se
+ * zkopírují těsně za sebe, procházení tabulky je pak lineární průchod pamětí
+ * a odpadá režie @c malloc pro každou položku. Index se jen přepíše na nová
+ * místa položek, nealokuje se. Tabulka dále přiděluje položky z areny.
+ *
+ * @warning Ukazatele na položky přestanou platit.
+ *
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ *
+ * @return @c VALUE_ERROR pro tabulku s hodnotami v položkách
+ *         (@c hash_map_config_t::value_size), které nelze přesunout po
+ *         bajtech, @c MEMORY_ERROR v případě chyby v alokaci paměti (tabulka
+ *         zůstane v obou případech beze změny), jinak @c OK.
+ */
+hash_map_state_code_t hash_map_compact(hash_map_t* self);
+
+/*******************************************************************************
+ * Statistiky
+ ******************************************************************************/
+/**
+ * @brief Paměť, zaplnění a délky hledání tabulky.
+ *
+ * Bez procházení (@p scan @c false) má konstantní složitost a lze ji volat
+ * průběžně. S procházením se navíc pro každý uložený klíč spočítá délka
+ * hledání (@c probe_average, @c probe_max), bez čtení položek, jen z indexu a
+ * uložených hašů, což je jeden průchod indexem.
+ *
+ * Při překladu s definovaným @c HASH_MAP_STATS vyhledávání počítá
+ * @c lookups a @c lookup_probes, jejich podíl je průměrná délka skutečných
+ * hledání včetně nenalezených klíčů. Počítadla mění tabulku i při čtení,
+ * souběžné čtení (@c hash_map_concurrent_t) s nimi není bezpečné.
+ *
+ * Příklad užití:
+ * @code{.c}
+ * hash_map_stats_t stats;
+ * hash_map_stats(map, &stats, true);
+ * if (stats.probe_max > 32)
+ * {
+ *     // spatna hasovaci funkce pro tyto klice
+ * }
+ * @endcode
+ *
+ * @param[in]  self  Ukazatel na strukturu hašovací tabulky.
+ * @param[out] stats Statistiky.
+ * @param[in]  scan  Spočítat délky hledání uložených klíčů.
+ */
+void hash_map_stats(hash_map_t* self, hash_map_stats_t* stats, bool scan);
+
+/*******************************************************************************
+ * Uložení do souboru a mapování do paměti
+ ******************************************************************************/
+/**
+ * @brief Tabulka otevřená jen pro čtení přímo nad souborem z @c hash_map_save.
+ *
+ * Soubor obsahuje hlavičku, index, záznamy v pořadí vložení a klíče, vše
+ * adresované posuny od začátku souboru. Po namapování (@c mmap) se hledá
+ * přímo v datech souboru bez jakéhokoliv vkládání, stránky načte systém až
+ * při prvním přístupu.
+ */
+typedef struct hash_map_mapped
+{
+    const char* data;           ///< Začátek souboru v paměti
+    size_t length;              ///< Velikost souboru
+    const uint64_t* slots;      ///< Index, viz @c hash_map_save
+    size_t slot_count;          ///< Velikost indexu, mocnina dvou
+    const char* entries;        ///< Záznamy v pořadí vložení
+    const char* keys;           ///< Klíče ukončené nulou
+    size_t keys_length;         ///< Velikost oblasti klíčů
+    size_t count;               ///< Počet záznamů
+    hash_map_hash_function_t hash_function; ///< Hašovací funkce klíčů
+    size_t seed;                ///< Semínko hašovací funkce
+    bool mapped;                ///< Data jsou namapovaná, jinak alokovaná
+} hash_map_mapped_t;
+
+/**
+ * @brief Uloží klíče a hodnoty tabulky do souboru pro @c hash_map_open_mapped.
+ *
+ * Soubor obsahuje vlastní index s lineárním prohledáváním, zaplněný nejvýše
+ * ze 3/4. Každá pozice má 8 bajtů: horní polovina haše klíče jako otisk a
+ * pořadí záznamu, volná pozice je nulová. Záznam nese celý haš, posun a délku
+ * klíče a hodnotu. Čísla jsou uložena v pořadí bajtů stroje, který soubor
+ * zapsal. Hašovací funkce se neukládá, uloží se jen semínko a kontrolní haš.
+ *
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ * @param[in] path Cesta k souboru, existující soubor se přepíše.
+ *
+ * @return @c VALUE_ERROR pro tabulku s hodnotami v položkách
+ *         (@c hash_map_config_t::value_size) nebo s více než @c UINT32_MAX
+ *         záznamy, @c MEMORY_ERROR při chybě alokace, @c IO_ERROR při chybě
+ *         zápisu, jinak @c OK.
+ */
+hash_map_state_code_t hash_map_save(hash_map_t* self, const char* path);
+
+/**
+ * @brief Otevře soubor z @c hash_map_save jen pro čtení.
+ *
+ * Příklad užití:
+ * @code{.c}
+ * hash_map_save(map, "map.bin");
+ * // pri dalsim startu
+ * hash_map_mapped_t* mapped = hash_map_open_mapped("map.bin", NULL);
+ * int value;
+ * hash_map_mapped_get(mapped, "aloha", &value);
+ * @endcode
+ *
+ * Kromě hlavičky projde při otevření celý index, aby vyhledávání nemohlo
+ * cyklit ani číst mimo záznamy poškozeného souboru.
+ *
+ * @param[in] path          Cesta k souboru.
+ * @param[in] hash_function Hašovací funkce tabulky, která soubor uložila,
+ *                          @c NULL znamená @c hash_map_hash_wy.
+ *
+ * @return Ukazatel na tabulku, nebo @c NULL pokud soubor nelze otevřít, není
+ *         platný nebo hašovací funkce neodpovídá kontrolnímu haši.
+ */
+hash_map_mapped_t* hash_map_open_mapped(const char* path, hash_map_hash_function_t hash_function);
+
+/**
+ * @brief Zavře tabulku z @c hash_map_open_mapped a uvolní mapování.
+ *
+ * @param[in] self Ukazatel na tabulku.
+ */
+void hash_map_mapped_close(hash_map_mapped_t* self);
+
+/**
+ * @brief Počet záznamů uložené tabulky.
+ */
+size_t hash_map_mapped_size(const hash_map_mapped_t* self);
+
+/**
+ * @brief Hodnota záznamu s daným klíčem, viz @c hash_map_get.
+ */
+hash_map_state_code_t hash_map_mapped_get(const hash_map_mapped_t* self, const char* key,
+                                          int* dst);
+
+/**
+ * @brief Hodnota záznamu s klíčem dané délky, viz @c hash_map_get_hashed.
+ *
+ * @param[in]  self   Ukazatel na tabulku.
+ * @param[in]  key    Klíč, nemusí být ukončen nulou.
+ * @param[in]  length Délka klíče.
+ * @param[out] dst    Hodnota záznamu.
+ *
+ * @return @c KEY_ERROR pokud se klíč nenachází v tabulce, jinak @c OK.
+ */
+hash_map_state_code_t hash_map_mapped_get_key(const hash_map_mapped_t* self, const char* key,
+                                              size_t length, int* dst);
+
+/**
+ * @brief Obsahuje uložená tabulka záznam s daným klíčem?
+ */
+bool hash_map_mapped_contains(const hash_map_mapped_t* self, const char* key);
+
+/*******************************************************************************
+ * Souběžná hašovací tabulka
+ ******************************************************************************/
+/** Část souběžné tabulky se zámkem, definice je skrytá v implementaci. */
+typedef struct hash_map_shard hash_map_shard_t;
+
+/**
+ * @brief Hašovací tabulka pro souběžný přístup z více vláken.
+ *
+ * Klíče jsou rozděleny podle bitů haše do částí, každá část je samostatná
+ * @c hash_map_t se svým zámkem pro čtení a zápis. Čtení (@c get, 
+ * @c contains) stejné části mohou probíhat současně, zápis ji zamkne
+ * výhradně. Vlákna pracující s různými částmi se neblokují, realokace indexu
+ * zamkne jen jednu část. Samotná @c hash_map_t žádnou synchronizaci nemá.
+ */
+typedef struct hash_map_concurrent
+{
+    hash_map_shard_t* shards;   ///< Části tabulky
+    size_t shard_count;         ///< Počet částí, mocnina dvou
+    unsigned shard_bits;        ///< Dvojkový logaritmus počtu částí
+} hash_map_concurrent_t;
+
+/**
+ * @brief Konstruktor souběžné hašovací tabulky.
+ *
+ * Všechny části používají nastavení @p config, kapacita se mezi ně rozdělí.
+ * Hodnoty v položkách (@c hash_map_config_t::value_size) se nepoužijí.
+ *
+ * Příklad užití:
+ * @code{.c}
+ * hash_map_concurrent_t* map = hash_map_concurrent_ctor(0, NULL);
+ * // ve vlaknech
+ * hash_map_concurrent_put(map, "aloha", 5);
+ * @endcode
+ *
+ * @param[in] shards Počet částí, zaokrouhlí se nahoru na mocninu dvou, 0
+ *                   znamená @c HASH_MAP_CONCURRENT_SHARDS.
+ * @param[in] config Nastavení částí, nebo @c NULL pro výchozí.
+ *
+ * @return Ukazatel na tabulku, nebo @c NULL při chybě alokace.
+ */
+hash_map_concurrent_t* hash_map_concurrent_ctor(size_t shards, const hash_map_config_t* config);
+
+/**
+ * @brief Destruktor souběžné hašovací tabulky.
+ *
+ * @warning Tabulku nesmí v tu chvíli používat žádné jiné vlákno.
+ *
+ * @param[in] self Ukazatel na strukturu tabulky.
+ */
+void hash_map_concurrent_dtor(hash_map_concurrent_t* self);
+
+/**
+ * @brief Počet vložených záznamů.
+ *
+ * Části se sčítají postupně, při souběžných změnách výsledek nemusí odpovídat
+ * žádnému okamžiku.
+ *
+ * @param[in] self Ukazatel na strukturu tabulky.
+ *
+ * @return Počet vložených záznamů.
+ */
+size_t hash_map_concurrent_size(hash_map_concurrent_t* self);
+
+/**
+ * @brief Obsahuje tabulka záznam s daným klíčem? Viz @c hash_map_contains.
+ */
+bool hash_map_concurrent_contains(hash_map_concurrent_t* self, const char* key);
+
+/**
+ * @brief Vložení nebo přepsání záznamu, viz @c hash_map_put.
+ */
+hash_map_state_code_t hash_map_concurrent_put(hash_map_concurrent_t* self, const char* key,
+                                              int value);
+
+/**
+ * @brief Hodnota záznamu s daným klíčem, viz @c hash_map_get.
+ */
+hash_map_state_code_t hash_map_concurrent_get(hash_map_concurrent_t* self, const char* key,
+                                              int* dst);
+
+/**
+ * @brief Odstranění záznamu a předání jeho hodnoty, viz @c hash_map_pop.
+ */
+hash_map_state_code_t hash_map_concurrent_pop(hash_map_concurrent_t* self, const char* key,
+                                              int* dst);
+
+/**
+ * @brief Odstranění záznamu, viz @c hash_map_remove.
+ */
+hash_map_state_code_t hash_map_concurrent_remove(hash_map_concurrent_t* self, const char* key);
+
 }       // extern "C" ending
 
+#include <iterator>
+#include <new>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+/**
+ * @brief Iterátor položek tabulky v pořadí vložení pro C++ cyklus @c for.
+ *
+ * Dereference vrací dvojici klíč a odkaz na hodnotu.
+ *
+ * @tparam V      Typ hodnoty.
+ * @tparam Inline @c true pro hodnoty uložené v položce (@c HashMap), @c false
+ *                pro @c int hodnotu položky C rozhraní.
+ */
+template <typename V, bool Inline>
+class HashMapIterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::pair<std::string_view, V&>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = value_type;
+
+    explicit HashMapIterator(hash_map_item_t* item = nullptr) : item_(item) {}
+
+    value_type operator*() const
+    {
+        if constexpr (Inline)
+        {
+            return {std::string_view(item_->key, item_->length), *static_cast<V*>(hash_map_item_value(item_))};
+        }
+        else
+        {
+            return {std::string_view(item_->key, item_->length), item_->value};
+        }
+    }
+
+    HashMapIterator& operator++()
+    {
+        item_ = item_->next;
+        return *this;
+    }
+
+    HashMapIterator operator++(int)
+    {
+        HashMapIterator previous = *this;
+        item_ = item_->next;
+        return previous;
+    }
+
+    bool operator==(const HashMapIterator& other) const
+    {
+        return item_ == other.item_;
+    }
+
+    bool operator!=(const HashMapIterator& other) const
+    {
+        return item_ != other.item_;
+    }
+
+private:
+    hash_map_item_t* item_;
+};
+
+/**
+ * @brief Rozsah položek tabulky C rozhraní.
+ *
+ * Příklad užití:
+ * @code{.cpp}
+ * for (auto [key, value] : hash_map_items(map))
+ * {
+ *     value++;
+ * }
+ * @endcode
+ */
+class HashMapItems
+{
+public:
+    explicit HashMapItems(hash_map_t* map) : map_(map) {}
+
+    HashMapIterator<int, false> begin() const
+    {
+        return HashMapIterator<int, false>(map_->first);
+    }
+
+    HashMapIterator<int, false> end() const
+    {
+        return HashMapIterator<int, false>();
+    }
+
+private:
+    hash_map_t* map_;
+};
+
+/** @brief Rozsah položek tabulky pro C++ cyklus @c for, viz @c HashMapItems. */
+inline HashMapItems hash_map_items(hash_map_t* map)
+{
+    return HashMapItems(map);
+}
+
+/**
+ * @brief Hašovací tabulka s hodnotami typu @p V uloženými přímo v položkách.
+ *
+ * Obal nad C rozhraním s @c hash_map_config_t::value_size . Hodnoty se
+ * konstruují na místě v bloku položky (bez další alokace), vkládají se
+ * přesunem a odebírají se přesunem ven. Položky se při realokaci indexu
+ * nepřesouvají, ukazatele vrácené @c find a @c emplace proto platí až do
+ * odstranění klíče. Chyba alokace vyvolá @c std::bad_alloc .
+ *
+ * Příklad užití:
+ * @code{.cpp}
+ * HashMap<std::string> map;
+ * map.emplace("aloha", 5, 'x');
+ * std::string* value = map.find("aloha");
+ * @endcode
+ *
+ * @tparam V Typ hodnoty, zarovnání nejvýše @c HASH_MAP_VALUE_ALIGN .
+ */
+template <typename V>
+class HashMap
+{
+    static_assert(alignof(V) <= HASH_MAP_VALUE_ALIGN, "HashMap value is over-aligned");
+
+public:
+    /**
+     * @brief Vytvoří prázdnou tabulku.
+     *
+     * @param config Nastavení tabulky, @c value_size se nastaví na velikost @p V .
+     */
+    explicit HashMap(hash_map_config_t config = hash_map_config_t())
+    {
+        config.value_size = sizeof(V);
+        map_ = hash_map_ctor_with_config(&config);
+        if (map_ == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+    }
+
+    ~HashMap()
+    {
+        if (map_ != nullptr)
+        {
+            destroyValues();
+            hash_map_dtor(map_);
+        }
+    }
+
+    HashMap(const HashMap&) = delete;
+    HashMap& operator=(const HashMap&) = delete;
+
+    HashMap(HashMap&& other) noexcept : map_(other.map_)
+    {
+        other.map_ = nullptr;
+    }
+
+    HashMap& operator=(HashMap&& other) noexcept
+    {
+        std::swap(map_, other.map_);
+        return *this;
+    }
+
+    /**
+     * @brief Zkonstruuje hodnotu z @p args, pokud klíč v tabulce není.
+     *
+     * @return Ukazatel na hodnotu klíče a zda byla vložena. Existující hodnota
+     *         se nemění a @p args se nepoužijí.
+     */
+    template <typename... Args>
+    std::pair<V*, bool> emplace(std::string_view key, Args&&... args)
+    {
+        size_t hash = hash_map_hash_key(map_, key.data(), key.size());
+        bool inserted = false;
+        void* slot = hash_map_emplace_hashed(map_, key.data(), key.size(), hash, &inserted);
+        if (slot == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        if (inserted)
+        {
+            try
+            {
+                new (slot) V(std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                // polozka bez zkonstruovane hodnoty se odebere bez ruseni
+                hash_map_pop_value_hashed(map_, key.data(), key.size(), hash, nullptr, nullptr);
+                throw;
+            }
+        }
+        return {static_cast<V*>(slot), inserted};
+    }
+
+    /**
+     * @brief Vloží hodnotu, nebo přiřadí existující hodnotě klíče.
+     *
+     * @return @c true pokud byl klíč nově vložen.
+     */
+    template <typename T>
+    bool insert_or_assign(std::string_view key, T&& value)
+    {
+        std::pair<V*, bool> result = emplace(key, std::forward<T>(value));
+        if (!result.second)
+        {
+            *result.first = std::forward<T>(value);
+        }
+        return result.second;
+    }
+
+    /** @brief Hodnota klíče, nebo @c nullptr. */
+    V* find(std::string_view key) const
+    {
+        return static_cast<V*>(hash_map_find_value_hashed(map_, key.data(), key.size(),
+                                                          hash_map_hash_key(map_, key.data(), key.size())));
+    }
+
+    /** @brief Obsahuje tabulka klíč? */
+    bool contains(std::string_view key) const
+    {
+        return find(key) != nullptr;
+    }
+
+    /**
+     * @brief Odstraní klíč a zruší jeho hodnotu.
+     *
+     * @return @c true pokud byl klíč v tabulce.
+     */
+    bool erase(std::string_view key)
+    {
+        return hash_map_pop_value_hashed(map_, key.data(), key.size(),
+                                         hash_map_hash_key(map_, key.data(), key.size()),
+                                         &HashMap::destroyValue, nullptr) == OK;
+    }
+
+    /**
+     * @brief Odstraní klíč a přesune jeho hodnotu ven.
+     *
+     * @return Hodnota klíče, nebo prázdná hodnota pokud klíč v tabulce nebyl.
+     */
+    std::optional<V> take(std::string_view key)
+    {
+        std::optional<V> result;
+        hash_map_pop_value_hashed(map_, key.data(), key.size(),
+                                  hash_map_hash_key(map_, key.data(), key.size()),
+                                  &HashMap::moveValue, &result);
+        return result;
+    }
+
+    /** @brief Počet klíčů v tabulce. */
+    size_t size() const
+    {
+        return hash_map_size(map_);
+    }
+
+    /** @brief Zruší všechny hodnoty a vyprázdní tabulku. */
+    void clear()
+    {
+        destroyValues();
+        hash_map_clear(map_);
+    }
+
+    /**
+     * @brief Zavolá @p visit(klíč, hodnota) pro všechny položky v pořadí vložení.
+     */
+    template <typename F>
+    void forEach(F&& visit) const
+    {
+        for (hash_map_item_t* item = map_->first; item != nullptr; item = item->next)
+        {
+            visit(std::string_view(item->key, item->length), *static_cast<V*>(hash_map_item_value(item)));
+        }
+    }
+
+    /** @brief Iterátor na první položku v pořadí vložení. */
+    HashMapIterator<V, true> begin() const
+    {
+        return HashMapIterator<V, true>(map_->first);
+    }
+
+    /** @brief Iterátor za poslední položku. */
+    HashMapIterator<V, true> end() const
+    {
+        return HashMapIterator<V, true>();
+    }
+
+    /** @brief Podkladová tabulka C rozhraní. */
+    hash_map_t* handle() const
+    {
+        return map_;
+    }
+
+private:
+    static void destroyValue(void* value, void*)
+    {
+        static_cast<V*>(value)->~V();
+    }
+
+    static void moveValue(void* value, void* context)
+    {
+        V* source = static_cast<V*>(value);
+        static_cast<std::optional<V>*>(context)->emplace(std::move(*source));
+        source->~V();
+    }
+
+    void destroyValues()
+    {
+        for (hash_map_item_t* item = map_->first; item != nullptr; item = item->next)
+        {
+            destroyValue(hash_map_item_value(item), nullptr);
+        }
+    }
+
+    hash_map_t* map_;
+};
+
 #endif  // HASH_MAP_H_
 
 /*** Konec souboru white_box_code.h ***/
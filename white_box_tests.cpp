@@ -13,6 +13,16 @@
  * @brief Implementace testu hasovaci tabulky.
  */
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -73,7 +83,10 @@ protected:
 class SameHashDifferentKeys : public Test{
 
     void SetUp(){
-        hashMap = hash_map_ctor();
+        // anagrams collide only with the additive hash
+        hash_map_config_t config = {};
+        config.hash_function = hash_map_hash_additive;
+        hashMap = hash_map_ctor_with_config(&config);
         std::vector<const char*> fruits = {"apple", "leapp", "banana", "orange"};
         int idx = 2;
         for (auto fruit : fruits){
@@ -95,7 +108,9 @@ protected:
 class HashCollision : public Test{
 
     void SetUp(){
-        hashMap = hash_map_ctor();
+        hash_map_config_t config = {};
+        config.hash_function = hash_map_hash_additive;
+        hashMap = hash_map_ctor_with_config(&config);
         // "abc" and "bce" have different hashes, but with hash map
         // of size 8 map to the same index
         std::vector<const char*> fruits = {"abc", "apple", "bce", "banana"};
@@ -114,6 +129,133 @@ protected:
     hash_map_t *hashMap;
 };
 
+// Fixture for tests with hash map allocating items from an arena
+class ArenaHashMap : public Test{
+
+    void SetUp(){
+        hash_map_config_t config = {};
+        config.arena = true;
+        hashMap = hash_map_ctor_with_config(&config);
+        std::vector<const char*> fruits = {"apple", "pear", "banana", "orange"};
+        int idx = 2;
+        for (auto fruit : fruits){
+            hash_map_put(hashMap, fruit, idx);
+            idx++;
+        }
+    }
+
+    void TearDown(){
+        hash_map_dtor(hashMap);
+    }
+
+protected:
+    hash_map_t *hashMap;
+};
+
+class GroupHashMap : public Test{
+
+    void SetUp(){
+        hashMap = hash_map_ctor_with_engine(HASH_MAP_ENGINE_GROUP);
+        std::vector<const char*> fruits = {"apple", "pear", "banana", "orange"};
+        int idx = 2;
+        for (auto fruit : fruits){
+            hash_map_put(hashMap, fruit, idx);
+            idx++;
+        }
+    }
+
+    void TearDown(){
+        hash_map_dtor(hashMap);
+    }
+
+protected:
+    hash_map_t *hashMap;
+};
+
+// Start of hash function tests
+TEST(HashFunction, additive){
+    EXPECT_EQ(hash_map_hash_additive("apple", 5, 0), hash_map_hash_additive("leapp", 5, 0));
+    EXPECT_EQ(hash_map_hash_additive("apple", 5, 0), hash_map_hash_additive("apple", 5, 7));
+    EXPECT_EQ(hash_map_hash_additive("", 0, 0), 0);
+}
+
+TEST(HashFunction, wy){
+    EXPECT_NE(hash_map_hash_wy("apple", 5, 0), hash_map_hash_wy("leapp", 5, 0));
+    EXPECT_NE(hash_map_hash_wy("apple", 5, 0), hash_map_hash_wy("apple", 5, 1));
+    EXPECT_EQ(hash_map_hash_wy("apple", 5, 3), hash_map_hash_wy("apple", 5, 3));
+
+    // Only first length bytes are used, for every code path (0, 1-3, 4-16, 17-48, >48)
+    std::string text(200, 'x');
+    for (size_t i = 0; i < text.size(); i++){
+        text[i] = (char)('a' + i * 7 % 26);
+    }
+    std::set<size_t> hashes;
+    for (size_t length = 0; length <= 130; length++){
+        std::string key = text.substr(0, length);
+        EXPECT_EQ(hash_map_hash_wy(text.c_str(), length, 0), hash_map_hash_wy(key.c_str(), length, 0));
+        hashes.insert(hash_map_hash_wy(key.c_str(), length, 0));
+    }
+    EXPECT_EQ(hashes.size(), 131);
+
+    // Similar ids differ in the low bits used by a small index
+    std::set<size_t> slots;
+    for (int id = 0; id < 64; id++){
+        std::string key = "user_" + std::to_string(id);
+        slots.insert(hash_map_hash_wy(key.c_str(), key.size(), 0) % 64);
+    }
+    EXPECT_GT(slots.size(), 32);
+}
+
+TEST(HashFunction, config){
+    hash_map_config_t config = {};
+    config.seed = 12345;
+    hash_map_t* map = hash_map_ctor_with_config(&config);
+    ASSERT_NE(map, nullptr);
+    EXPECT_EQ(map->hash_function, hash_map_hash_wy);
+    EXPECT_EQ(map->seed, 12345);
+    EXPECT_EQ(hash_map_put(map, "apple", 1), OK);
+    EXPECT_EQ(map->first->hash, hash_map_hash_wy("apple", 5, 12345));
+    EXPECT_TRUE(hash_map_contains(map, "apple"));
+    hash_map_dtor(map);
+
+    map = hash_map_ctor_with_config(NULL);
+    ASSERT_NE(map, nullptr);
+    EXPECT_EQ(map->hash_function, hash_map_hash_wy);
+    hash_map_dtor(map);
+}
+
+// Presized index takes the given key count without resizing
+TEST(HashMapCapacity, ctor){
+    hash_map_t* map = hash_map_ctor_with_capacity(1000);
+    ASSERT_NE(map, nullptr);
+    EXPECT_EQ(hash_map_capacity(map), 2048);
+    for (int i = 0; i < 1000; i++){
+        EXPECT_EQ(hash_map_put(map, ("key" + std::to_string(i)).c_str(), i), OK);
+    }
+    EXPECT_EQ(hash_map_capacity(map), 2048);
+    int dst = -42;
+    EXPECT_EQ(hash_map_get(map, "key512", &dst), OK);
+    EXPECT_EQ(dst, 512);
+    hash_map_dtor(map);
+
+    map = hash_map_ctor_with_capacity(0);
+    ASSERT_NE(map, nullptr);
+    EXPECT_EQ(hash_map_capacity(map), HASH_MAP_INIT_SIZE);
+    hash_map_dtor(map);
+
+    hash_map_config_t config = {};
+    config.engine = HASH_MAP_ENGINE_GROUP;
+    config.capacity = 1000;
+    map = hash_map_ctor_with_config(&config);
+    ASSERT_NE(map, nullptr);
+    EXPECT_EQ(hash_map_capacity(map), 2048);
+    for (int i = 0; i < 1000; i++){
+        hash_map_put(map, ("key" + std::to_string(i)).c_str(), i);
+    }
+    EXPECT_EQ(hash_map_capacity(map), 2048);
+    hash_map_dtor(map);
+}
+
 // Start of EMPTY hash map tests
 TEST_F(EmptyHashMap, hash_map_clear){
     hash_map_clear(hashMap);
@@ -249,6 +391,125 @@ TEST_F(NonEmptyHashMap, hash_map_put_3){
     EXPECT_EQ(retCode, KEY_ALREADY_EXISTS);
 }
 
+// Items stay reachable after several resizings
+TEST_F(NonEmptyHashMap, hash_map_put_many){
+    for (int i = 0; i < 1000; i++){
+        EXPECT_EQ(hash_map_put(hashMap, ("key" + std::to_string(i)).c_str(), i), OK);
+    }
+    EXPECT_EQ(hash_map_size(hashMap), 1004);
+    EXPECT_GE(hash_map_capacity(hashMap), 1004);
+
+    int dst = -42;
+    for (int i = 0; i < 1000; i++){
+        EXPECT_EQ(hash_map_get(hashMap, ("key" + std::to_string(i)).c_str(), &dst), OK);
+        EXPECT_EQ(dst, i);
+    }
+    EXPECT_EQ(hash_map_get(hashMap, "apple", &dst), OK);
+    EXPECT_EQ(dst, 2);
+}
+
+// Batches longer than HASH_MAP_BATCH_SIZE with duplicates and resizing inside
+TEST_F(NonEmptyHashMap, hash_map_put_batch){
+    std::vector<std::string> names;
+    for (int i = 0; i < 40; i++){
+        names.push_back("key" + std::to_string(i));
+    }
+    names.push_back("apple");
+    names.push_back("key7");
+    std::vector<const char*> keys;
+    std::vector<int> values;
+    for (size_t i = 0; i < names.size(); i++){
+        keys.push_back(names[i].c_str());
+        values.push_back((int)i);
+    }
+
+    std::vector<hash_map_state_code_t> results(keys.size());
+    EXPECT_EQ(hash_map_put_many(hashMap, keys.data(), values.data(), keys.size(), results.data()), OK);
+    EXPECT_EQ(results[0], OK);
+    EXPECT_EQ(results[39], OK);
+    EXPECT_EQ(results[40], KEY_ALREADY_EXISTS);
+    EXPECT_EQ(results[41], KEY_ALREADY_EXISTS);
+    EXPECT_EQ(hash_map_size(hashMap), 44);
+
+    int dst = -42;
+    EXPECT_EQ(hash_map_get(hashMap, "key7", &dst), OK);
+    EXPECT_EQ(dst, 41);
+    EXPECT_EQ(hash_map_put_many(hashMap, keys.data(), values.data(), 0, NULL), OK);
+}
+
+TEST_F(NonEmptyHashMap, hash_map_get_batch){
+    const char* keys[] = {"apple", "grapes", "orange", "pear", "", "banana"};
+    int values[6] = {-1, -1, -1, -1, -1, -1};
+    hash_map_state_code_t results[6];
+    EXPECT_EQ(hash_map_get_many(hashMap, keys, 6, values, results), 4);
+    EXPECT_EQ(values[0], 2);
+    EXPECT_EQ(values[1], -1);
+    EXPECT_EQ(values[2], 5);
+    EXPECT_EQ(values[5], 4);
+    EXPECT_EQ(results[1], KEY_ERROR);
+    EXPECT_EQ(results[4], KEY_ERROR);
+    EXPECT_EQ(results[3], OK);
+
+    bool found[6];
+    EXPECT_EQ(hash_map_contains_many(hashMap, keys, 6, found), 4);
+    EXPECT_TRUE(found[0]);
+    EXPECT_FALSE(found[1]);
+    EXPECT_FALSE(found[4]);
+    EXPECT_EQ(hash_map_contains_many(hashMap, keys, 6, NULL), 4);
+}
+
+// Keys taken from a buffer without terminating NUL, hashed once
+TEST_F(NonEmptyHashMap, hash_map_put_hashed){
+    const char buffer[] = "pineapplepearx";
+    size_t hash = hash_map_hash_key(hashMap, buffer, 9);
+    EXPECT_EQ(hash, hash_map_hash_wy("pineapple", 9, 0));
+    EXPECT_FALSE(hash_map_contains_hashed(hashMap, buffer, 9, hash));
+    EXPECT_EQ(hash_map_put_hashed(hashMap, buffer, 9, hash, 7), OK);
+    EXPECT_STREQ(hashMap->last->key, "pineapple");
+    EXPECT_EQ(hashMap->last->length, 9);
+    EXPECT_TRUE(hash_map_contains(hashMap, "pineapple"));
+
+    // Prefix and the whole key differ in length
+    EXPECT_EQ(hash_map_put_hashed(hashMap, buffer + 9, 4, hash_map_hash_key(hashMap, buffer + 9, 4), 1),
+              KEY_ALREADY_EXISTS);
+    EXPECT_FALSE(hash_map_contains_hashed(hashMap, buffer, 4, hash_map_hash_key(hashMap, buffer, 4)));
+
+    int dst = -42;
+    EXPECT_EQ(hash_map_get_hashed(hashMap, buffer, 9, hash, &dst), OK);
+    EXPECT_EQ(dst, 7);
+    EXPECT_EQ(hash_map_get(hashMap, "pear", &dst), OK);
+    EXPECT_EQ(dst, 1);
+    EXPECT_EQ(hash_map_pop_hashed(hashMap, buffer, 9, hash, &dst), OK);
+    EXPECT_EQ(hash_map_pop_hashed(hashMap, buffer, 9, hash, &dst), KEY_ERROR);
+    EXPECT_EQ(hash_map_size(hashMap), 4);
+}
+
+// Key with an embedded NUL is compared by its length
+TEST_F(NonEmptyHashMap, hash_map_put_hashedBinary){
+    const char key[] = {'a', 'p', 'p', 'l', 'e', '\0', 'x'};
+    size_t hash = hash_map_hash_key(hashMap, key, sizeof(key));
+    EXPECT_EQ(hash_map_put_hashed(hashMap, key, sizeof(key), hash, 9), OK);
+    EXPECT_EQ(hash_map_size(hashMap), 5);
+    EXPECT_TRUE(hash_map_contains_hashed(hashMap, key, sizeof(key), hash));
+
+    int dst = -42;
+    EXPECT_EQ(hash_map_get(hashMap, "apple", &dst), OK);
+    EXPECT_EQ(dst, 2);
+}
+
+// Key is copied right behind the item
+TEST_F(NonEmptyHashMap, hash_map_put_inlineKey){
+    char key[] = "pineapple";
+    EXPECT_EQ(hash_map_put(hashMap, key, 4), OK);
+    key[0] = 'P';
+
+    EXPECT_EQ(hashMap->last->key, (char*)(hashMap->last + 1));
+    EXPECT_STREQ(hashMap->last->key, "pineapple");
+    EXPECT_TRUE(hash_map_contains(hashMap, "pineapple"));
+    EXPECT_FALSE(hash_map_contains(hashMap, key));
+    EXPECT_EQ(hash_map_remove(hashMap, "pineapple"), OK);
+}
+
 // Checking correct size updating
 TEST_F(NonEmptyHashMap, hash_map_put_usedSize){
     hash_map_put(hashMap, "pineapple", 4);
@@ -320,6 +581,91 @@ TEST_F(NonEmptyHashMap, hash_map_pop){
     EXPECT_NE(dst, -42);
 }
 
+// Removed slots are counted and reused by following insertions
+TEST_F(NonEmptyHashMap, hash_map_remove_deleted){
+    EXPECT_EQ(hashMap->deleted, 0);
+    EXPECT_EQ(hash_map_remove(hashMap, "apple"), OK);
+    EXPECT_EQ(hash_map_remove(hashMap, "grapes"), KEY_ERROR);
+    EXPECT_EQ(hashMap->deleted, 1);
+
+    EXPECT_EQ(hash_map_put(hashMap, "apple", 1), OK);
+    EXPECT_EQ(hashMap->deleted, 0);
+    EXPECT_EQ(hash_map_size(hashMap), 4);
+
+    hash_map_clear(hashMap);
+    EXPECT_EQ(hashMap->deleted, 0);
+}
+
+// Put/pop churn of a constant key count rebuilds the index instead of growing it
+TEST_F(NonEmptyHashMap, hash_map_remove_churn){
+    for (int i = 0; i < 10000; i++){
+        EXPECT_EQ(hash_map_put(hashMap, ("key" + std::to_string(i)).c_str(), i), OK);
+        if (i >= 1){
+            EXPECT_EQ(hash_map_remove(hashMap, ("key" + std::to_string(i - 1)).c_str()), OK);
+        }
+    }
+    EXPECT_EQ(hash_map_size(hashMap), 5);
+    EXPECT_EQ(hash_map_capacity(hashMap), 16);
+    EXPECT_LT(hashMap->deleted, 16);
+    EXPECT_TRUE(hash_map_contains(hashMap, "key9999"));
+    EXPECT_TRUE(hash_map_contains(hashMap, "banana"));
+    EXPECT_FALSE(hash_map_contains(hashMap, "key9998"));
+}
+
+// Sparse index is halved only when enabled
+TEST_F(NonEmptyHashMap, hash_map_remove_shrink){
+    for (int i = 0; i < 1000; i++){
+        hash_map_put(hashMap, ("key" + std::to_string(i)).c_str(), i);
+    }
+    size_t capacity = hash_map_capacity(hashMap);
+    for (int i = 0; i < 1000; i++){
+        hash_map_remove(hashMap, ("key" + std::to_string(i)).c_str());
+    }
+    EXPECT_EQ(hash_map_capacity(hashMap), capacity);
+
+    hash_map_config_t config = {};
+    config.shrink = true;
+    hash_map_t* map = hash_map_ctor_with_config(&config);
+    ASSERT_NE(map, nullptr);
+    for (int i = 0; i < 1000; i++){
+        hash_map_put(map, ("key" + std::to_string(i)).c_str(), i);
+    }
+    EXPECT_EQ(hash_map_capacity(map), capacity);
+    for (int i = 0; i < 995; i++){
+        EXPECT_EQ(hash_map_remove(map, ("key" + std::to_string(i)).c_str()), OK);
+    }
+    EXPECT_EQ(hash_map_capacity(map), 16);
+    EXPECT_EQ(map->deleted, 0);
+
+    int dst = -42;
+    for (int i = 995; i < 1000; i++){
+        EXPECT_EQ(hash_map_get(map, ("key" + std::to_string(i)).c_str(), &dst), OK);
+        EXPECT_EQ(dst, i);
+    }
+    hash_map_dtor(map);
+}
+
+// Slots are rejected by their tag without comparing the item
+TEST_F(NonEmptyHashMap, hash_map_tags){
+    size_t appleIdx = hashMap->allocated;
+    for (size_t i = 0; i < hashMap->allocated; i++){
+        if (hashMap->index[i] != nullptr && strcmp(hashMap->index[i]->key, "apple") == 0){
+            appleIdx = i;
+        }
+    }
+    ASSERT_LT(appleIdx, hashMap->allocated);
+
+    hashMap->tags[appleIdx] ^= 0xff;
+    EXPECT_FALSE(hash_map_contains(hashMap, "apple"));
+    hashMap->tags[appleIdx] ^= 0xff;
+    EXPECT_TRUE(hash_map_contains(hashMap, "apple"));
+
+    // Tags survive resizing
+    hash_map_reserve(hashMap, 64);
+    EXPECT_TRUE(hash_map_contains(hashMap, "apple"));
+    EXPECT_TRUE(hash_map_contains(hashMap, "orange"));
+}
+
 // Start of SameHashDifferentKeys hash map tests
 TEST_F(SameHashDifferentKeys, hash_map_size){
     EXPECT_EQ(hash_map_size(hashMap), 4);
@@ -339,6 +685,19 @@ TEST_F(SameHashDifferentKeys, hash_map_contains){
     EXPECT_EQ(retVal, 0);
 }
 
+// Equal hashes have equal tags, the keys are told apart by strcmp
+TEST_F(SameHashDifferentKeys, hash_map_tags){
+    std::vector<size_t> slots;
+    for (size_t i = 0; i < hashMap->allocated; i++){
+        if (hashMap->index[i] != nullptr && (strcmp(hashMap->index[i]->key, "apple") == 0 ||
+                                             strcmp(hashMap->index[i]->key, "leapp") == 0)){
+            slots.push_back(i);
+        }
+    }
+    ASSERT_EQ(slots.size(), 2);
+    EXPECT_EQ(hashMap->tags[slots[0]], hashMap->tags[slots[1]]);
+}
+
 TEST_F(SameHashDifferentKeys, hash_map_put){
     auto retCode = hash_map_put(hashMap, "ppale", 9);
     EXPECT_EQ(retCode, OK);
@@ -347,6 +706,16 @@ TEST_F(SameHashDifferentKeys, hash_map_put){
     EXPECT_NE(retVal, 0);
 }
 
+// Key behind a removed slot of the same probe chain is not inserted twice
+TEST_F(SameHashDifferentKeys, hash_map_put_afterRemove){
+    EXPECT_EQ(hash_map_remove(hashMap, "apple"), OK);
+    EXPECT_EQ(hash_map_put(hashMap, "leapp", 9), KEY_ALREADY_EXISTS);
+    EXPECT_EQ(hash_map_size(hashMap), 3);
+
+    EXPECT_EQ(hash_map_remove(hashMap, "leapp"), OK);
+    EXPECT_FALSE(hash_map_contains(hashMap, "leapp"));
+}
+
 TEST_F(SameHashDifferentKeys, hash_map_get){
     int dst = -42;
     auto retCode = hash_map_get(hashMap, "leapp", &dst);
@@ -430,4 +799,859 @@ TEST_F(HashCollision, hash_map_pop){
     EXPECT_EQ(retCode, OK);
     EXPECT_NE(dst, -42);
 }
+
+// Start of ArenaHashMap tests
+TEST_F(ArenaHashMap, hash_map_put){
+    ASSERT_NE(hashMap->arena, nullptr);
+    EXPECT_EQ(hash_map_put(hashMap, "apple", 9), KEY_ALREADY_EXISTS);
+
+    // Keys longer than the biggest size class and longer than the first chunk
+    std::string longKey(300, 'x');
+    std::string hugeKey(10000, 'y');
+    EXPECT_EQ(hash_map_put(hashMap, longKey.c_str(), 7), OK);
+    EXPECT_EQ(hash_map_put(hashMap, hugeKey.c_str(), 8), OK);
+    for (int i = 0; i < 1000; i++){
+        EXPECT_EQ(hash_map_put(hashMap, ("key" + std::to_string(i)).c_str(), i), OK);
+    }
+
+    int dst = -42;
+    EXPECT_EQ(hash_map_get(hashMap, hugeKey.c_str(), &dst), OK);
+    EXPECT_EQ(dst, 8);
+    EXPECT_EQ(hash_map_get(hashMap, "key999", &dst), OK);
+    EXPECT_EQ(dst, 999);
+    EXPECT_EQ(hash_map_size(hashMap), 1006);
+
+    // Items are aligned for the platform
+    for (hash_map_item_t* item = hashMap->first; item != NULL; item = item->next){
+        EXPECT_EQ((uintptr_t)item % HASH_MAP_ARENA_ALIGN, 0);
+    }
+}
+
+TEST_F(ArenaHashMap, hash_map_pop){
+    hash_map_item_t* banana = hashMap->first->next->next;
+    ASSERT_STREQ(banana->key, "banana");
+
+    int dst = -42;
+    EXPECT_EQ(hash_map_pop(hashMap, "banana", &dst), OK);
+    EXPECT_EQ(dst, 4);
+    EXPECT_FALSE(hash_map_contains(hashMap, "banana"));
+
+    // Popped item of the same size class is reused
+    EXPECT_EQ(hash_map_put(hashMap, "cherry", 10), OK);
+    EXPECT_EQ(hashMap->last, banana);
+    EXPECT_EQ(hash_map_get(hashMap, "cherry", &dst), OK);
+    EXPECT_EQ(dst, 10);
+    EXPECT_EQ(hash_map_get(hashMap, "orange", &dst), OK);
+    EXPECT_EQ(dst, 5);
+}
+
+TEST_F(ArenaHashMap, hash_map_clear){
+    for (int i = 0; i < 5000; i++){
+        hash_map_put(hashMap, ("key" + std::to_string(i)).c_str(), i);
+    }
+    hash_map_clear(hashMap);
+    EXPECT_EQ(hashMap->first, nullptr);
+    EXPECT_EQ(hashMap->last, nullptr);
+    EXPECT_FALSE(hash_map_contains(hashMap, "apple"));
+
+    // Only the last chunk is kept for refilling
+    ASSERT_NE(hashMap->arena->chunks, nullptr);
+    EXPECT_EQ(hashMap->arena->chunks->next, nullptr);
+
+    for (int i = 0; i < 100; i++){
+        EXPECT_EQ(hash_map_put(hashMap, ("key" + std::to_string(i)).c_str(), i), OK);
+    }
+    int dst = -42;
+    EXPECT_EQ(hash_map_get(hashMap, "key42", &dst), OK);
+    EXPECT_EQ(dst, 42);
+}
+
+// Start of GroupHashMap tests
+TEST_F(GroupHashMap, hash_map_capacity){
+    ASSERT_EQ(hashMap->engine, HASH_MAP_ENGINE_GROUP);
+    EXPECT_EQ(hash_map_capacity(hashMap), HASH_MAP_GROUP_WIDTH);
+
+    // Index is made of whole groups
+    EXPECT_EQ(hash_map_reserve(hashMap, 40), OK);
+    EXPECT_EQ(hash_map_capacity(hashMap), 48);
+    EXPECT_EQ(hash_map_reserve(hashMap, 3), VALUE_ERROR);
+    EXPECT_EQ(hash_map_capacity(hashMap), 48);
+
+    // At least one slot stays free
+    EXPECT_EQ(hash_map_reserve(hashMap, 4), OK);
+    EXPECT_EQ(hash_map_capacity(hashMap), 16);
+    EXPECT_FALSE(hash_map_contains(hashMap, "grapes"));
+}
+
+TEST_F(GroupHashMap, hash_map_put){
+    EXPECT_EQ(hash_map_put(hashMap, "apple", 9), KEY_ALREADY_EXISTS);
+    for (int i = 0; i < 1000; i++){
+        EXPECT_EQ(hash_map_put(hashMap, ("key" + std::to_string(i)).c_str(), i), OK);
+    }
+    EXPECT_EQ(hash_map_size(hashMap), 1004);
+    EXPECT_EQ(hash_map_capacity(hashMap) % HASH_MAP_GROUP_WIDTH, 0);
+    EXPECT_LE(hash_map_capacity(hashMap), 2048);
+
+    int dst = -42;
+    for (int i = 0; i < 1000; i++){
+        EXPECT_EQ(hash_map_get(hashMap, ("key" + std::to_string(i)).c_str(), &dst), OK);
+        EXPECT_EQ(dst, i);
+    }
+    EXPECT_EQ(hash_map_get(hashMap, "apple", &dst), OK);
+    EXPECT_EQ(dst, 9);
+    EXPECT_FALSE(hash_map_contains(hashMap, "key1000"));
+
+    // Insertion order is kept in the list
+    EXPECT_STREQ(hashMap->first->key, "apple");
+    EXPECT_STREQ(hashMap->first->next->key, "pear");
+    EXPECT_STREQ(hashMap->last->key, "key999");
+}
+
+TEST_F(GroupHashMap, hash_map_pop){
+    int dst = -42;
+    EXPECT_EQ(hash_map_pop(hashMap, "banana", &dst), OK);
+    EXPECT_EQ(dst, 4);
+    EXPECT_EQ(hash_map_pop(hashMap, "banana", &dst), KEY_ERROR);
+    EXPECT_FALSE(hash_map_contains(hashMap, "banana"));
+    EXPECT_STREQ(hashMap->first->next->next->key, "orange");
+
+    EXPECT_EQ(hash_map_put(hashMap, "banana", 7), OK);
+    EXPECT_EQ(hash_map_get(hashMap, "banana", &dst), OK);
+    EXPECT_EQ(dst, 7);
+    EXPECT_EQ(hashMap->last, hashMap->first->next->next->next);
+}
+
+// Keys with the same hash fill several groups, removed slots are reused
+TEST_F(GroupHashMap, hash_map_collisions){
+    hash_map_config_t config = {};
+    config.hash_function = hash_map_hash_additive;
+    config.engine = HASH_MAP_ENGINE_GROUP;
+    hash_map_t* map = hash_map_ctor_with_config(&config);
+    ASSERT_NE(map, nullptr);
+
+    std::string key = "abcde";
+    std::vector<std::string> keys;
+    do {
+        keys.push_back(key);
+    } while (std::next_permutation(key.begin(), key.end()));
+    ASSERT_EQ(keys.size(), 120);
+
+    EXPECT_EQ(hash_map_reserve(map, 128), OK);
+    for (size_t i = 0; i < keys.size(); i++){
+        EXPECT_EQ(hash_map_put(map, keys[i].c_str(), (int)i), OK);
+    }
+    EXPECT_EQ(hash_map_capacity(map), 256);
+    for (size_t i = 0; i < keys.size(); i += 2){
+        EXPECT_EQ(hash_map_remove(map, keys[i].c_str()), OK);
+    }
+
+    int dst = -42;
+    for (size_t i = 0; i < keys.size(); i++){
+        EXPECT_EQ(hash_map_get(map, keys[i].c_str(), &dst), i % 2 ? OK : KEY_ERROR);
+        if (i % 2){
+            EXPECT_EQ(dst, (int)i);
+        }
+    }
+    for (size_t i = 0; i < keys.size(); i += 2){
+        EXPECT_EQ(hash_map_put(map, keys[i].c_str(), -(int)i), OK);
+        EXPECT_EQ(hash_map_put(map, keys[i].c_str(), -(int)i), KEY_ALREADY_EXISTS);
+    }
+    EXPECT_EQ(hash_map_get(map, "edcba", &dst), OK);
+    EXPECT_EQ(dst, 119);
+    EXPECT_EQ(hash_map_get(map, "abcde", &dst), OK);
+    EXPECT_EQ(dst, 0);
+    hash_map_dtor(map);
+}
+
+TEST_F(GroupHashMap, hash_map_remove_churn){
+    for (int i = 0; i < 10000; i++){
+        EXPECT_EQ(hash_map_put(hashMap, ("key" + std::to_string(i)).c_str(), i), OK);
+        if (i >= 2){
+            EXPECT_EQ(hash_map_remove(hashMap, ("key" + std::to_string(i - 2)).c_str()), OK);
+        }
+    }
+    EXPECT_EQ(hash_map_size(hashMap), 6);
+    EXPECT_EQ(hash_map_capacity(hashMap), 16);
+    EXPECT_TRUE(hash_map_contains(hashMap, "key9999"));
+    EXPECT_FALSE(hash_map_contains(hashMap, "key9997"));
+
+    size_t deleted = 0;
+    for (size_t i = 0; i < hashMap->allocated; i++){
+        deleted += hashMap->index[i] == hashMap->dummy;
+    }
+    EXPECT_EQ(hashMap->deleted, deleted);
+}
+
+TEST_F(GroupHashMap, hash_map_get_batch){
+    std::vector<std::string> names;
+    std::vector<const char*> keys;
+    std::vector<int> values;
+    for (int i = 0; i < 100; i++){
+        names.push_back("key" + std::to_string(i));
+    }
+    for (size_t i = 0; i < names.size(); i++){
+        keys.push_back(names[i].c_str());
+        values.push_back((int)i);
+    }
+    EXPECT_EQ(hash_map_put_many(hashMap, keys.data(), values.data(), 50, NULL), OK);
+    EXPECT_EQ(hash_map_remove(hashMap, "key10"), OK);
+
+    std::vector<int> got(keys.size(), -1);
+    EXPECT_EQ(hash_map_get_many(hashMap, keys.data(), keys.size(), got.data(), NULL), 49);
+    EXPECT_EQ(got[9], 9);
+    EXPECT_EQ(got[10], -1);
+    EXPECT_EQ(got[49], 49);
+    EXPECT_EQ(got[50], -1);
+    EXPECT_EQ(hash_map_contains_many(hashMap, keys.data(), keys.size(), NULL), 49);
+}
+
+TEST_F(GroupHashMap, hash_map_clear){
+    hash_map_clear(hashMap);
+    EXPECT_EQ(hashMap->first, nullptr);
+    EXPECT_FALSE(hash_map_contains(hashMap, "apple"));
+    for (size_t i = 0; i < hashMap->allocated; i++){
+        EXPECT_EQ(hashMap->index[i], nullptr);
+    }
+
+    EXPECT_EQ(hash_map_put(hashMap, "apple", 1), OK);
+    EXPECT_TRUE(hash_map_contains(hashMap, "apple"));
+}
+
+// Start of HashMapValues tests
+struct CountedValue {
+    static int alive;
+    int value;
+    explicit CountedValue(int v) : value(v) { alive++; }
+    CountedValue(CountedValue&& other) : value(other.value) { alive++; }
+    CountedValue& operator=(CountedValue&& other) { value = other.value; return *this; }
+    ~CountedValue() { alive--; }
+};
+int CountedValue::alive = 0;
+
+// Values are constructed in place and keep their address
+TEST(HashMapValues, strings_surviveGrowth){
+    HashMap<std::string> map;
+    std::string* first = map.emplace("key0", 40, 'a').first;
+    for (int i = 1; i < 1000; i++){
+        EXPECT_TRUE(map.emplace("key" + std::to_string(i), "value" + std::to_string(i)).second);
+    }
+    EXPECT_EQ(map.size(), 1000u);
+    // Items do not move when the index is resized
+    EXPECT_EQ(map.find("key0"), first);
+    EXPECT_EQ(*first, std::string(40, 'a'));
+    ASSERT_NE(map.find("key999"), nullptr);
+    EXPECT_EQ(*map.find("key999"), "value999");
+    EXPECT_EQ((uintptr_t)first % HASH_MAP_VALUE_ALIGN, 0u);
+
+    EXPECT_FALSE(map.emplace("key5", "other").second);
+    EXPECT_EQ(*map.find("key5"), "value5");
+    EXPECT_FALSE(map.insert_or_assign("key5", std::string("other")));
+    EXPECT_EQ(*map.find("key5"), "other");
+    EXPECT_EQ(map.find("missing"), nullptr);
+}
+
+TEST(HashMapValues, moveOnly){
+    HashMap<std::unique_ptr<int>> map;
+    EXPECT_TRUE(map.emplace("one", new int(1)).second);
+    EXPECT_TRUE(map.insert_or_assign("two", std::make_unique<int>(2)));
+    EXPECT_EQ(**map.find("two"), 2);
+
+    std::optional<std::unique_ptr<int>> taken = map.take("one");
+    ASSERT_TRUE(taken.has_value());
+    EXPECT_EQ(**taken, 1);
+    EXPECT_FALSE(map.contains("one"));
+    EXPECT_FALSE(map.take("one").has_value());
+    EXPECT_EQ(map.size(), 1u);
+}
+
+TEST(HashMapValues, lifetime){
+    {
+        hash_map_config_t config = hash_map_config_t();
+        config.arena = true;
+        HashMap<CountedValue> map(config);
+        for (int i = 0; i < 100; i++){
+            map.emplace("key" + std::to_string(i), i);
+        }
+        EXPECT_EQ(CountedValue::alive, 100);
+        EXPECT_TRUE(map.erase("key3"));
+        EXPECT_FALSE(map.erase("key3"));
+        EXPECT_EQ(CountedValue::alive, 99);
+        {
+            std::optional<CountedValue> taken = map.take("key4");
+            EXPECT_EQ(taken->value, 4);
+            EXPECT_EQ(CountedValue::alive, 99);
+        }
+        EXPECT_EQ(CountedValue::alive, 98);
+        map.clear();
+        EXPECT_EQ(CountedValue::alive, 0);
+        EXPECT_EQ(map.size(), 0u);
+        map.emplace("again", 7);
+        EXPECT_EQ(map.find("again")->value, 7);
+
+        HashMap<CountedValue> moved(std::move(map));
+        EXPECT_EQ(moved.find("again")->value, 7);
+    }
+    EXPECT_EQ(CountedValue::alive, 0);
+}
+
+TEST(HashMapValues, forEach_insertionOrder){
+    HashMap<int> map;
+    map.emplace("c", 3);
+    map.emplace("a", 1);
+    map.emplace(std::string_view("b\0x", 3), 2);
+    map.erase("a");
+    std::vector<std::pair<std::string, int>> seen;
+    map.forEach([&](std::string_view key, int value){
+        seen.emplace_back(std::string(key), value);
+    });
+    ASSERT_EQ(seen.size(), 2u);
+    EXPECT_EQ(seen[0], std::make_pair(std::string("c"), 3));
+    EXPECT_EQ(seen[1], std::make_pair(std::string("b\0x", 3), 2));
+    // The C interface works on the same map
+    EXPECT_TRUE(hash_map_contains_hashed(map.handle(), "c", 1, hash_map_hash_key(map.handle(), "c", 1)));
+}
+
+// Start of ConcurrentHashMap tests
+TEST(ConcurrentHashMap, operations){
+    hash_map_concurrent_t* map = hash_map_concurrent_ctor(5, NULL);
+    ASSERT_NE(map, nullptr);
+    EXPECT_EQ(map->shard_count, 8u);
+    EXPECT_EQ(map->shard_bits, 3u);
+
+    int value = 0;
+    EXPECT_EQ(hash_map_concurrent_put(map, "apple", 1), OK);
+    EXPECT_EQ(hash_map_concurrent_put(map, "apple", 2), KEY_ALREADY_EXISTS);
+    EXPECT_EQ(hash_map_concurrent_get(map, "apple", &value), OK);
+    EXPECT_EQ(value, 2);
+    EXPECT_TRUE(hash_map_concurrent_contains(map, "apple"));
+    EXPECT_FALSE(hash_map_concurrent_contains(map, "pear"));
+    EXPECT_EQ(hash_map_concurrent_get(map, "pear", &value), KEY_ERROR);
+    EXPECT_EQ(hash_map_concurrent_size(map), 1u);
+
+    EXPECT_EQ(hash_map_concurrent_pop(map, "apple", &value), OK);
+    EXPECT_EQ(value, 2);
+    EXPECT_EQ(hash_map_concurrent_remove(map, "apple"), KEY_ERROR);
+    EXPECT_EQ(hash_map_concurrent_size(map), 0u);
+    hash_map_concurrent_dtor(map);
+}
+
+// Threads working on disjoint keys of one map
+TEST(ConcurrentHashMap, threads){
+    hash_map_config_t config = hash_map_config_t();
+    config.engine = HASH_MAP_ENGINE_GROUP;
+    hash_map_concurrent_t* map = hash_map_concurrent_ctor(0, &config);
+    ASSERT_NE(map, nullptr);
+    EXPECT_EQ(map->shard_count, (size_t)HASH_MAP_CONCURRENT_SHARDS);
+
+    const int threadCount = 4;
+    const int perThread = 2000;
+    std::vector<std::thread> threads;
+    std::vector<int> errors(threadCount, 0);
+    for (int t = 0; t < threadCount; t++){
+        threads.emplace_back([&, t](){
+            for (int i = 0; i < perThread; i++){
+                std::string key = "key" + std::to_string(t * perThread + i);
+                errors[t] += hash_map_concurrent_put(map, key.c_str(), i) != OK;
+                int value = -1;
+                errors[t] += hash_map_concurrent_get(map, key.c_str(), &value) != OK || value != i;
+                // Every second key is removed again
+                if (i % 2 == 1){
+                    errors[t] += hash_map_concurrent_remove(map, key.c_str()) != OK;
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads){
+        thread.join();
+    }
+
+    for (int t = 0; t < threadCount; t++){
+        EXPECT_EQ(errors[t], 0);
+    }
+    EXPECT_EQ(hash_map_concurrent_size(map), (size_t)threadCount * perThread / 2);
+    for (int i = 0; i < threadCount * perThread; i++){
+        std::string key = "key" + std::to_string(i);
+        EXPECT_EQ(hash_map_concurrent_contains(map, key.c_str()), i % 2 == 0);
+    }
+    hash_map_concurrent_dtor(map);
+}
+
+// Start of IncrementalHashMap tests
+// Growing migrates the old index a few slots per put
+TEST(IncrementalHashMap, grow){
+    for (hash_map_engine_t engine : {HASH_MAP_ENGINE_PERTURB, HASH_MAP_ENGINE_GROUP}){
+        hash_map_config_t config = hash_map_config_t();
+        config.engine = engine;
+        config.incremental = true;
+        hash_map_t* map = hash_map_ctor_with_config(&config);
+        ASSERT_NE(map, nullptr);
+
+        size_t migrations = 0;
+        for (int i = 0; i < 2000; i++){
+            std::string key = "key" + std::to_string(i);
+            bool migrating = map->old_index != NULL;
+            EXPECT_EQ(hash_map_put(map, key.c_str(), i), OK);
+            migrations += !migrating && map->old_index != NULL;
+            if (map->old_index != NULL){
+                // The old index is half the size and drains gradually
+                EXPECT_EQ(map->old_allocated * 2, map->allocated);
+            }
+            // All keys stay reachable during the migration
+            for (int j = 0; j <= i; j += 97){
+                int value = -1;
+                EXPECT_EQ(hash_map_get(map, ("key" + std::to_string(j)).c_str(), &value), OK);
+                EXPECT_EQ(value, j);
+            }
+        }
+        EXPECT_GE(migrations, 5u);
+        EXPECT_EQ(hash_map_size(map), 2000u);
+        hash_map_dtor(map);
+    }
+}
+
+// Random put/pop/get against a reference map, across migrations
+TEST(IncrementalHashMap, churn){
+    for (hash_map_engine_t engine : {HASH_MAP_ENGINE_PERTURB, HASH_MAP_ENGINE_GROUP}){
+        hash_map_config_t config = hash_map_config_t();
+        config.engine = engine;
+        config.incremental = true;
+        hash_map_t* map = hash_map_ctor_with_config(&config);
+        ASSERT_NE(map, nullptr);
+
+        std::map<std::string, int> model;
+        std::mt19937 rng(7);
+        bool sawMigration = false;
+        for (int i = 0; i < 20000; i++){
+            std::string key = "key" + std::to_string(rng() % (i < 10000 ? 4000 : 800));
+            int value = -1;
+            switch (rng() % 3){
+                case 0:
+                    EXPECT_EQ(hash_map_put(map, key.c_str(), i), model.count(key) ? KEY_ALREADY_EXISTS : OK);
+                    model[key] = i;
+                    break;
+                case 1:
+                    EXPECT_EQ(hash_map_pop(map, key.c_str(), &value), model.count(key) ? OK : KEY_ERROR);
+                    if (model.count(key)){
+                        EXPECT_EQ(value, model[key]);
+                        model.erase(key);
+                    }
+                    break;
+                default:
+                    EXPECT_EQ(hash_map_get(map, key.c_str(), &value), model.count(key) ? OK : KEY_ERROR);
+                    EXPECT_EQ(hash_map_contains(map, key.c_str()), model.count(key) == 1);
+                    break;
+            }
+            sawMigration |= map->old_index != NULL;
+            ASSERT_EQ(hash_map_size(map), model.size());
+        }
+        EXPECT_TRUE(sawMigration);
+
+        size_t listed = 0;
+        for (hash_map_item_t* item = map->first; item != NULL; item = item->next){
+            listed++;
+        }
+        EXPECT_EQ(listed, model.size());
+        hash_map_dtor(map);
+    }
+}
+
+TEST(IncrementalHashMap, reserveAndClear){
+    hash_map_config_t config = hash_map_config_t();
+    config.incremental = true;
+    hash_map_t* map = hash_map_ctor_with_config(&config);
+    ASSERT_NE(map, nullptr);
+    int i = 0;
+    while (map->old_index == NULL){
+        hash_map_put(map, ("key" + std::to_string(i)).c_str(), i);
+        i++;
+    }
+
+    // Rebuilding the index at once finishes the migration
+    EXPECT_EQ(hash_map_reserve(map, map->allocated * 2), OK);
+    EXPECT_EQ(map->old_index, nullptr);
+    for (int j = 0; j < i; j++){
+        EXPECT_TRUE(hash_map_contains(map, ("key" + std::to_string(j)).c_str()));
+    }
+
+    while (map->old_index == NULL){
+        hash_map_put(map, ("key" + std::to_string(i)).c_str(), i);
+        i++;
+    }
+    hash_map_clear(map);
+    EXPECT_EQ(map->old_index, nullptr);
+    EXPECT_EQ(hash_map_size(map), 0u);
+    EXPECT_FALSE(hash_map_contains(map, "key0"));
+    EXPECT_EQ(hash_map_put(map, "key0", 1), OK);
+    hash_map_dtor(map);
+}
+
+// Start of iterator and compact hash map tests
+// Iteration follows insertion order
+TEST_F(NonEmptyHashMap, hash_map_iter){
+    std::vector<std::string> keys;
+    std::vector<int> values;
+    hash_map_iter_t iter = hash_map_iter_begin(hashMap);
+    const char* key;
+    size_t length;
+    int value;
+    while (hash_map_iter_next(&iter, &key, &length, &value)){
+        EXPECT_EQ(strlen(key), length);
+        keys.push_back(key);
+        values.push_back(value);
+    }
+    EXPECT_FALSE(hash_map_iter_next(&iter, &key, &length, &value));
+    ASSERT_EQ(keys.size(), hash_map_size(hashMap));
+
+    std::vector<std::string> expected;
+    for (hash_map_item_t* item = hashMap->first; item != NULL; item = item->next){
+        expected.push_back(item->key);
+    }
+    EXPECT_EQ(keys, expected);
+
+    // The returned entry may be removed while iterating
+    iter = hash_map_iter_begin(hashMap);
+    while (hash_map_iter_next(&iter, &key, NULL, NULL)){
+        EXPECT_EQ(hash_map_remove(hashMap, key), OK);
+    }
+    EXPECT_EQ(hash_map_size(hashMap), 0u);
+    iter = hash_map_iter_begin(hashMap);
+    EXPECT_FALSE(hash_map_iter_next(&iter, NULL, NULL, NULL));
+}
+
+// Range adaptor yields references to the stored values
+TEST_F(NonEmptyHashMap, hash_map_items){
+    size_t count = 0;
+    for (auto [key, value] : hash_map_items(hashMap)){
+        int stored = 0;
+        EXPECT_EQ(hash_map_get(hashMap, std::string(key).c_str(), &stored), OK);
+        EXPECT_EQ(value, stored);
+        value++;
+        count++;
+    }
+    EXPECT_EQ(count, hash_map_size(hashMap));
+    int value = 0;
+    EXPECT_EQ(hash_map_get(hashMap, "apple", &value), OK);
+    EXPECT_EQ(value, 3);
+    EXPECT_EQ(std::distance(hash_map_items(hashMap).begin(), hash_map_items(hashMap).end()),
+              (std::ptrdiff_t)hash_map_size(hashMap));
+}
+
+TEST(HashMapValues, rangeFor){
+    HashMap<std::string> map;
+    map.emplace("b", "2");
+    map.emplace("a", "1");
+    std::string joined;
+    for (auto [key, value] : map){
+        joined += std::string(key) + "=" + value + ";";
+        value += "!";
+    }
+    EXPECT_EQ(joined, "b=2;a=1;");
+    EXPECT_EQ(*map.find("a"), "1!");
+}
+
+// Compaction keeps order and content and packs the items into one chunk
+TEST(HashMapCompact, orderAndContiguity){
+    for (hash_map_engine_t engine : {HASH_MAP_ENGINE_PERTURB, HASH_MAP_ENGINE_GROUP}){
+        hash_map_config_t config = hash_map_config_t();
+        config.engine = engine;
+        config.incremental = true;
+        hash_map_t* map = hash_map_ctor_with_config(&config);
+        ASSERT_NE(map, nullptr);
+        for (int i = 0; i < 1000; i++){
+            EXPECT_EQ(hash_map_put(map, ("key" + std::to_string(i)).c_str(), i), OK);
+        }
+        for (int i = 0; i < 1000; i += 3){
+            EXPECT_EQ(hash_map_remove(map, ("key" + std::to_string(i)).c_str()), OK);
+        }
+        std::vector<std::string> before;
+        for (auto [key, value] : hash_map_items(map)){
+            before.emplace_back(key);
+        }
+
+        EXPECT_EQ(hash_map_compact(map), OK);
+        EXPECT_NE(map->arena, nullptr);
+        EXPECT_EQ(map->old_index, nullptr);
+        std::vector<std::string> after;
+        hash_map_item_t* prev = NULL;
+        for (hash_map_item_t* item = map->first; item != NULL; item = item->next){
+            after.emplace_back(item->key);
+            EXPECT_EQ(item->prev, prev);
+            EXPECT_EQ(item->key, (char*)(item + 1));
+            // Items lie back to back
+            if (prev != NULL){
+                EXPECT_EQ((char*)item, (char*)prev + ((sizeof(hash_map_item_t) + prev->length + 1 + HASH_MAP_ARENA_ALIGN - 1) & ~(size_t)(HASH_MAP_ARENA_ALIGN - 1)));
+            }
+            prev = item;
+        }
+        EXPECT_EQ(map->last, prev);
+        EXPECT_EQ(after, before);
+
+        for (int i = 0; i < 1000; i++){
+            int value = -1;
+            EXPECT_EQ(hash_map_get(map, ("key" + std::to_string(i)).c_str(), &value), i % 3 == 0 ? KEY_ERROR : OK);
+            EXPECT_EQ(value, i % 3 == 0 ? -1 : i);
+        }
+        EXPECT_EQ(hash_map_remove(map, "key1"), OK);
+        EXPECT_EQ(hash_map_put(map, "key0", 0), OK);
+        EXPECT_EQ(hash_map_size(map), before.size());
+        EXPECT_EQ(std::string(map->last->key), "key0");
+        hash_map_dtor(map);
+    }
+}
+
+TEST_F(EmptyHashMap, hash_map_compact){
+    EXPECT_EQ(hash_map_compact(hashMap), OK);
+    EXPECT_EQ(hashMap->first, nullptr);
+    EXPECT_EQ(hash_map_put(hashMap, "apple", 1), OK);
+    EXPECT_TRUE(hash_map_contains(hashMap, "apple"));
+}
+
+// Inline values may not survive a bytewise move, such maps are left as they are
+TEST(HashMapCompact, inlineValues){
+    HashMap<std::string> values;
+    values.emplace("apple", std::string(64, 'a'));
+    values.emplace("pear", "short");
+    hash_map_item_t* first = values.handle()->first;
+    EXPECT_EQ(hash_map_compact(values.handle()), VALUE_ERROR);
+    EXPECT_EQ(values.handle()->first, first);
+    EXPECT_EQ(values.size(), 2);
+}
+
+// Start of stats hash map tests
+// Sizes and counters are kept up to date without scanning
+TEST_F(NonEmptyHashMap, hash_map_stats){
+    hash_map_stats_t stats;
+    hash_map_stats(hashMap, &stats, false);
+    EXPECT_EQ(stats.size, 4u);
+    EXPECT_EQ(stats.capacity, 8u);
+    EXPECT_EQ(stats.tombstones, 0u);
+    EXPECT_DOUBLE_EQ(stats.load_factor, 0.5);
+    EXPECT_EQ(stats.key_bytes, strlen("apple pear banana orange") + 1);
+    EXPECT_EQ(stats.item_bytes, 4 * sizeof(hash_map_item_t));
+    EXPECT_EQ(stats.index_bytes, 8 * (sizeof(hash_map_item_t*) + 1));
+    EXPECT_EQ(stats.arena_bytes, 0u);
+    EXPECT_EQ(stats.total_bytes, sizeof(hash_map_t) + sizeof(hash_map_item_t) + stats.index_bytes +
+                                 stats.item_bytes + stats.key_bytes);
+    EXPECT_EQ(stats.resizes, 0u);
+    EXPECT_EQ(stats.probe_max, 0u);
+
+    EXPECT_EQ(hash_map_remove(hashMap, "pear"), OK);
+    hash_map_stats(hashMap, &stats, true);
+    EXPECT_EQ(stats.tombstones, 1u);
+    EXPECT_DOUBLE_EQ(stats.fill_factor, 0.5);
+    EXPECT_EQ(stats.key_bytes, strlen("apple banana orange") + 1);
+    EXPECT_GE(stats.probe_average, 1.0);
+    EXPECT_GE(stats.probe_max, 1u);
+
+    for (int i = 0; i < 100; i++){
+        hash_map_put(hashMap, ("key" + std::to_string(i)).c_str(), i);
+    }
+    hash_map_stats(hashMap, &stats, false);
+    EXPECT_EQ(stats.resizes, 5u);
+    hash_map_clear(hashMap);
+    hash_map_stats(hashMap, &stats, true);
+    EXPECT_EQ(stats.key_bytes, 0u);
+    EXPECT_EQ(stats.probe_average, 0.0);
+}
+
+// Colliding keys need longer probes
+TEST_F(HashCollision, hash_map_stats){
+    hash_map_stats_t stats;
+    hash_map_stats(hashMap, &stats, true);
+    EXPECT_GE(stats.probe_max, 2u);
+    EXPECT_GT(stats.probe_average, 1.0);
+
+    size_t total = 0;
+    for (size_t idx = 0; idx < hashMap->allocated; idx++){
+        if (hashMap->index[idx] != NULL){
+            total++;
+        }
+    }
+    EXPECT_EQ(total, stats.size);
+#ifdef HASH_MAP_STATS
+    EXPECT_GT(stats.lookups, 0u);
+#else
+    EXPECT_EQ(stats.lookups, 0u);
+#endif
+}
+
+// Probe lengths count groups and cover the old index during a migration
+TEST(HashMapStats, groupAndMigration){
+    hash_map_config_t config = hash_map_config_t();
+    config.engine = HASH_MAP_ENGINE_GROUP;
+    config.incremental = true;
+    config.arena = true;
+    hash_map_t* map = hash_map_ctor_with_config(&config);
+    ASSERT_NE(map, nullptr);
+    int i = 0;
+    while (map->old_index == NULL){
+        hash_map_put(map, ("key" + std::to_string(i)).c_str(), i);
+        i++;
+    }
+
+    hash_map_stats_t stats;
+    hash_map_stats(map, &stats, true);
+    EXPECT_EQ(stats.size, (size_t)i);
+    EXPECT_EQ(stats.index_bytes, (map->allocated + map->old_allocated) * (sizeof(hash_map_item_t*) + 1));
+    EXPECT_GT(stats.arena_bytes, stats.item_bytes + stats.key_bytes);
+    EXPECT_GE(stats.probe_average, 1.0);
+    EXPECT_LE(stats.probe_average, 2.0);
+    EXPECT_GE(stats.resizes, 1u);
+    hash_map_dtor(map);
+}
+
+// Start of HashMapSave tests
+// Saved map answers the same queries from the mapped file
+TEST_F(NonEmptyHashMap, hash_map_save){
+    std::string path = testing::TempDir() + "white_box_saved.bin";
+    EXPECT_EQ(hash_map_put_hashed(hashMap, "nul\0key", 7, hash_map_hash_key(hashMap, "nul\0key", 7), 9), OK);
+    EXPECT_EQ(hash_map_remove(hashMap, "pear"), OK);
+    ASSERT_EQ(hash_map_save(hashMap, path.c_str()), OK);
+
+    hash_map_mapped_t* mapped = hash_map_open_mapped(path.c_str(), NULL);
+    ASSERT_NE(mapped, nullptr);
+    EXPECT_EQ(hash_map_mapped_size(mapped), 4u);
+    for (hash_map_item_t* item = hashMap->first; item != NULL; item = item->next){
+        int value = -1;
+        EXPECT_EQ(hash_map_mapped_get_key(mapped, item->key, item->length, &value), OK);
+        EXPECT_EQ(value, item->value);
+    }
+    int value = -1;
+    EXPECT_EQ(hash_map_mapped_get(mapped, "apple", &value), OK);
+    EXPECT_EQ(value, 2);
+    EXPECT_EQ(hash_map_mapped_get(mapped, "pear", &value), KEY_ERROR);
+    EXPECT_FALSE(hash_map_mapped_contains(mapped, "nul"));
+    EXPECT_TRUE(hash_map_mapped_contains(mapped, "banana"));
+    hash_map_mapped_close(mapped);
+
+    // A different hash function is detected by the check hash
+    EXPECT_EQ(hash_map_open_mapped(path.c_str(), hash_map_hash_additive), nullptr);
+    std::remove(path.c_str());
+}
+
+// Many keys with a custom hash function and seed, and an empty map
+TEST(HashMapSave, largeAndEmpty){
+    std::string path = testing::TempDir() + "white_box_large.bin";
+    hash_map_config_t config = hash_map_config_t();
+    config.engine = HASH_MAP_ENGINE_GROUP;
+    config.seed = 1234;
+    hash_map_t* map = hash_map_ctor_with_config(&config);
+    ASSERT_NE(map, nullptr);
+    for (int i = 0; i < 20000; i++){
+        hash_map_put(map, ("key" + std::to_string(i)).c_str(), i);
+    }
+    ASSERT_EQ(hash_map_save(map, path.c_str()), OK);
+    hash_map_mapped_t* mapped = hash_map_open_mapped(path.c_str(), hash_map_hash_wy);
+    ASSERT_NE(mapped, nullptr);
+    EXPECT_EQ(mapped->seed, 1234u);
+    EXPECT_EQ(mapped->slot_count & (mapped->slot_count - 1), 0u);
+    EXPECT_LE(mapped->count * 4, mapped->slot_count * 3);
+    for (int i = 0; i < 20000; i++){
+        int value = -1;
+        EXPECT_EQ(hash_map_mapped_get(mapped, ("key" + std::to_string(i)).c_str(), &value), OK);
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(hash_map_mapped_contains(mapped, "key20000"));
+    hash_map_mapped_close(mapped);
+
+    hash_map_clear(map);
+    ASSERT_EQ(hash_map_save(map, path.c_str()), OK);
+    mapped = hash_map_open_mapped(path.c_str(), NULL);
+    ASSERT_NE(mapped, nullptr);
+    EXPECT_EQ(hash_map_mapped_size(mapped), 0u);
+    EXPECT_FALSE(hash_map_mapped_contains(mapped, "key0"));
+    hash_map_mapped_close(mapped);
+    hash_map_dtor(map);
+    std::remove(path.c_str());
+}
+
+// Invalid files and maps that cannot be saved
+TEST(HashMapSave, errors){
+    std::string path = testing::TempDir() + "white_box_invalid.bin";
+    EXPECT_EQ(hash_map_open_mapped((path + ".missing").c_str(), NULL), nullptr);
+
+    hash_map_t* map = hash_map_ctor();
+    ASSERT_NE(map, nullptr);
+    hash_map_put(map, "apple", 1);
+    ASSERT_EQ(hash_map_save(map, path.c_str()), OK);
+    std::ifstream input(path, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    input.close();
+
+    // Truncated file
+    std::ofstream(path, std::ios::binary).write(content.data(), content.size() - 1);
+    EXPECT_EQ(hash_map_open_mapped(path.c_str(), NULL), nullptr);
+    // Wrong magic
+    std::string corrupted = content;
+    corrupted[0] = 'X';
+    std::ofstream(path, std::ios::binary).write(corrupted.data(), corrupted.size());
+    EXPECT_EQ(hash_map_open_mapped(path.c_str(), NULL), nullptr);
+    std::remove(path.c_str());
+
+    EXPECT_EQ(hash_map_save(map, (testing::TempDir() + "missing_dir/map.bin").c_str()), IO_ERROR);
+    hash_map_dtor(map);
+
+    HashMap<int> values;
+    values.emplace("apple", 1);
+    EXPECT_EQ(hash_map_save(values.handle(), path.c_str()), VALUE_ERROR);
+}
+
+// Corrupted index slots are rejected at open instead of looping or reading past the entries
+TEST(HashMapSave, corruptedSlots){
+    std::string path = testing::TempDir() + "white_box_slots.bin";
+    hash_map_t* map = hash_map_ctor();
+    ASSERT_NE(map, nullptr);
+    hash_map_put(map, "apple", 1);
+    ASSERT_EQ(hash_map_save(map, path.c_str()), OK);
+    hash_map_dtor(map);
+    std::ifstream input(path, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    input.close();
+
+    // header: magic, count, slot_count, seed, check, slots_offset, ...
+    auto word = [](const std::string& data, size_t offset){
+        uint64_t value;
+        memcpy(&value, data.data() + offset, sizeof(value));
+        return value;
+    };
+    auto setWord = [](std::string& data, size_t offset, uint64_t value){
+        memcpy(&data[offset], &value, sizeof(value));
+    };
+    auto opens = [&](const std::string& data){
+        std::ofstream(path, std::ios::binary | std::ios::trunc).write(data.data(), data.size());
+        hash_map_mapped_t* mapped = hash_map_open_mapped(path.c_str(), NULL);
+        if (mapped != NULL){
+            hash_map_mapped_close(mapped);
+        }
+        return mapped != NULL;
+    };
+    uint64_t slotCount = word(content, 16);
+    uint64_t slotsOffset = word(content, 40);
+    size_t used = 0;
+    for (uint64_t i = 0; i < slotCount; i++){
+        if (word(content, slotsOffset + i * 8) != 0){
+            used = slotsOffset + i * 8;
+        }
+    }
+    ASSERT_NE(used, 0);
+    EXPECT_TRUE(opens(content));
+
+    // No empty slot, a lookup would never stop probing
+    std::string full = content;
+    for (uint64_t i = 0; i < slotCount; i++){
+        if (word(full, slotsOffset + i * 8) == 0){
+            setWord(full, slotsOffset + i * 8, (uint64_t(0xdead) << 32) | 1);
+        }
+    }
+    EXPECT_FALSE(opens(full));
+
+    // Matching tag but order 0 or past the entries
+    std::string zero = content;
+    setWord(zero, used, word(content, used) & ~uint64_t(0xffffffff));
+    EXPECT_FALSE(opens(zero));
+    std::string past = content;
+    setWord(past, used, (word(content, used) & ~uint64_t(0xffffffff)) | 2);
+    EXPECT_FALSE(opens(past));
+    std::remove(path.c_str());
+}
 /*** Konec souboru white_box_tests.cpp ***/